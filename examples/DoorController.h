@@ -33,7 +33,8 @@ class ClosingState;
 // Base state for common door functionality
 class DoorState : public State {
 protected:
-    AlarmTimer* stateTimer{nullptr};
+    explicit DoorState(unsigned long timeout = 0) : State(timeout) {}
+
     void stopMotor() const {
         digitalWrite(MOTOR_OPEN_PIN, LOW);
         digitalWrite(MOTOR_CLOSE_PIN, LOW);
@@ -58,9 +59,7 @@ public:
 // State: Door is opening
 class OpeningState final : public DoorState {
 public:
-    explicit OpeningState(unsigned long timeout = OPENING_TIME) : DoorState() {
-        stateTimer = new AlarmTimer(timeout);
-    }
+    explicit OpeningState(unsigned long timeout = OPENING_TIME) : DoorState(timeout) {}
 
     void onEnter(Event* event) const override {
         digitalWrite(MOTOR_OPEN_PIN, HIGH);
@@ -77,9 +76,7 @@ public:
 // State: Door is fully open
 class OpenState final : public DoorState {
 public:
-    explicit OpenState(unsigned long timeout = OPEN_TIME) : DoorState() {
-        stateTimer = new AlarmTimer(timeout);
-    }
+    explicit OpenState(unsigned long timeout = OPEN_TIME) : DoorState(timeout) {}
 
     void onEnter(Event* event) const override {
         stopMotor();
@@ -94,9 +91,7 @@ public:
 // State: Door is closing
 class ClosingState final : public DoorState {
 public:
-    explicit ClosingState(unsigned long timeout = CLOSING_TIME) : DoorState() {
-        stateTimer = new AlarmTimer(timeout);
-    }
+    explicit ClosingState(unsigned long timeout = CLOSING_TIME) : DoorState(timeout) {}
 
     void onEnter(Event* event) const override {
         digitalWrite(MOTOR_OPEN_PIN, LOW);
@@ -0,0 +1,186 @@
+/**
+* Benchmark of event recording and replay with the traffic light controller.
+ *
+ * Responsibilities:
+ * - Simulates a day of pedestrian and emergency button traffic on virtual time and records it.
+ * - Replays the trace twice as fast as possible and checks that both replays
+ *   produce the same transition sequence as the recording.
+ *
+ * Design Considerations:
+ * - The "field" buttons are pseudo-random, so the recorded day is the same on every run.
+ * - Transitions are compared through a hash of (state index, virtual time) pairs.
+ */
+
+#include "TrafficLightController.h"
+#include "events/EventTrace.h"
+#include "fsm/TransitionObserver.h"
+
+constexpr unsigned long DAY = 24UL * 60UL * 60UL * 1000UL; ///< Simulated time in milliseconds.
+
+/**
+ * Growable in-memory trace.
+ */
+class TraceBuffer final : public Print {
+    uint8_t* data{nullptr};
+    size_t length{0};
+    size_t capacity{0};
+
+public:
+    size_t write(const uint8_t byte) override {
+        if (length == capacity) {
+            capacity = capacity ? capacity * 2 : 256;
+            auto grown = new uint8_t[capacity];
+            memcpy(grown, data, length);
+            delete[] data;
+            data = grown;
+        }
+        data[length++] = byte;
+        return 1;
+    }
+
+    using Print::write;
+
+    const uint8_t* getData() const { return data; }
+    size_t getLength() const { return length; }
+};
+
+/**
+ * Button pressed at pseudo-random intervals, released 200 ms later.
+ */
+class FieldButtonSource final : public BaseEventSource {
+    uint8_t pin;
+    unsigned long meanInterval;
+    unsigned long seed;
+    unsigned long nextPress;
+    bool pressed{false};
+
+    unsigned long nextInterval() {
+        seed = seed * 1103515245UL + 12345UL;
+        return meanInterval / 2 + (seed >> 8) % meanInterval;
+    }
+
+public:
+    FieldButtonSource(const uint8_t pin, const unsigned long mean, const unsigned long initialSeed)
+        : pin{pin}, meanInterval{mean}, seed{initialSeed} {
+        nextPress = nextInterval();
+    }
+
+    Event* getEvent() override {
+        const unsigned long now = Clock::now();
+        if (!pressed && now >= nextPress) {
+            pressed = true;
+            return Event::buttonPressed->setByteValue(pin);
+        }
+        if (pressed && now >= nextPress + 200) {
+            pressed = false;
+            nextPress += nextInterval();
+            return Event::buttonReleased->setByteValue(pin);
+        }
+        return Event::none;
+    }
+};
+
+/**
+ * Hashes every transition of an FSM.
+ */
+class TransitionHash final : public TransitionObserver {
+public:
+    unsigned long hash{2166136261UL};
+    unsigned long count{0};
+
+    void onTransition(FSM* fsm, const State* from, const State* to, const Event* event) override {
+        const unsigned long values[] = { static_cast<unsigned long>(fsm->indexOf(to)), Clock::now() };
+        for (const unsigned long value : values) {
+            hash = (hash ^ value) * 16777619UL;
+        }
+        count++;
+    }
+};
+
+TraceBuffer trace; ///< Trace of the simulated day.
+
+/**
+ * Prints the result of one run.
+ *
+ * @param label Name of the run.
+ * @param observer Transition hash of the run.
+ * @param elapsed Wall time in microseconds.
+ */
+void report(const char* label, const TransitionHash& observer, const unsigned long elapsed) {
+    Serial.print(label);
+    Serial.print(F(": "));
+    Serial.print(observer.count);
+    Serial.print(F(" transitions, hash "));
+    Serial.print(observer.hash);
+    Serial.print(F(", "));
+    Serial.print(elapsed / 1000UL);
+    Serial.println(F(" ms"));
+}
+
+/**
+ * Simulates and records a day of traffic.
+ *
+ * @return The transition hash of the recorded day.
+ */
+unsigned long recordDay() {
+    EventRecorder recorder(trace);
+    auto pedestrian = new RecordingEventSource(new FieldButtonSource(PEDESTRIAN_BUTTON_PIN, 90000, 1), &recorder, 0);
+    auto emergency = new RecordingEventSource(new FieldButtonSource(EMERGENCY_BUTTON_PIN, 3600000, 2), &recorder, 1);
+    auto controller = new TrafficLightController(pedestrian, emergency);
+    TransitionHash observer;
+    controller->getFSM()->setObserver(&observer);
+
+    const unsigned long start = micros();
+    Clock::useVirtual();
+    recorder.begin();
+    controller->begin();
+    while (Clock::now() < DAY) {
+        controller->update();
+        Clock::advance(1);
+    }
+    Clock::useReal();
+    report("Record", observer, micros() - start);
+
+    Serial.print(F("  trace: "));
+    Serial.print(recorder.getTotalRecords());
+    Serial.print(F(" events, "));
+    Serial.print(static_cast<unsigned long>(trace.getLength()));
+    Serial.println(F(" bytes"));
+    return observer.hash;
+}
+
+/**
+ * Replays the recorded day.
+ *
+ * @return The transition hash of the replay.
+ */
+unsigned long replayDay() {
+    EventPlayer player(trace.getData(), trace.getLength());
+    auto controller = new TrafficLightController(new ReplayEventSource(&player, 0), new ReplayEventSource(&player, 1));
+    TransitionHash observer;
+    controller->getFSM()->setObserver(&observer);
+
+    const unsigned long start = micros();
+    player.begin();
+    controller->begin();
+    while (Clock::now() < DAY) {
+        controller->update();
+        if (!player.step()) Clock::advance(1);
+    }
+    player.end();
+    report("Replay", observer, micros() - start);
+    return observer.hash;
+}
+
+void setup() {
+    Serial.begin(9600);
+
+    const unsigned long recorded = recordDay();
+    const unsigned long first = replayDay();
+    const unsigned long second = replayDay();
+    Serial.println(recorded == first && first == second ? F("Identical transition sequences")
+                                                        : F("Transition sequences differ"));
+}
+
+void loop() {
+}
@@ -0,0 +1,116 @@
+/**
+ * Benchmark of loading and running a large machine from a binary image.
+ *
+ * Responsibilities:
+ * - Writes the image of a 10,000-state protocol-like machine: every state moves on
+ *   a condition, on one of two events, or on a timeout.
+ * - Measures `FSMImage::load`, `FSMImage::verify` and the first steps of an `ImageFSM`
+ *   over that image, and reports the image size.
+ *
+ * Design Considerations:
+ * - The image is written into a buffer here; on a host it would rather be a
+ *   memory-mapped file, and on a target a constant array in flash.
+ * - `load` only checks the header, so its cost does not depend on the state count;
+ *   `verify` is linear and only needed for untrusted images.
+ */
+
+#include "fsm/ImageFSM.h"
+
+constexpr uint32_t STATES = 10000;            ///< States in the machine.
+constexpr uint32_t TRANSITIONS = STATES * 4;  ///< Condition, two events and a timeout per state.
+constexpr unsigned long STEPS = 100000;       ///< Steps run after loading.
+
+bool overload = false;                        ///< Condition bound as guard 0.
+Event* next = new Event(EventType::EVENT_CUSTOM);  ///< Event 0: go to the next state.
+Event* back = new Event(EventType::EVENT_CUSTOM);  ///< Event 1: go to the previous state.
+
+/**
+ * Source delivering `next` on most steps and `back` on every third.
+ */
+class Stimulus final : public BaseEventSource {
+    unsigned long count{0};
+
+public:
+    Event* getEvent() override { return ++count % 3 == 0 ? back : next; }
+};
+
+/**
+ * Writes the machine's image.
+ *
+ * @param buffer Destination of `FSMImage::sizeFor(STATES, TRANSITIONS)` bytes.
+ * @return The size of the image, or 0 on failure.
+ */
+size_t writeImage(uint8_t* buffer) {
+    FSMImageWriter writer(buffer, FSMImage::sizeFor(STATES, TRANSITIONS), STATES, TRANSITIONS);
+    for (uint32_t s = 0; s < STATES; s++) {
+        writer.addState(1000 + s % 500, 0);
+        writer.addTransition(CONDITION_TRANSITION, 0, 0);
+        writer.addTransition(EVENT_TRANSITION, (s + 1) % STATES, FSMImage::NO_BINDING, 0, 0);
+        writer.addTransition(EVENT_TRANSITION, (s + STATES - 1) % STATES, FSMImage::NO_BINDING, 1, 0);
+        writer.addTransition(TIMEOUT_TRANSITION, 0);
+    }
+    return writer.finish();
+}
+
+void setup() {
+    Serial.begin(115200);
+    static Stimulus stimulus;
+    static unsigned long entered = 0;
+    static const ImageBindings::Guard guards[] = { [] { return overload; } };
+    static const ImageBindings::Hook hooks[] = { [](Event*) { entered++; } };
+    static Event* const events[] = { next, back };
+    static BaseEventSource* const sources[] = { &stimulus };
+    ImageBindings bindings;
+    bindings.guards = guards;
+    bindings.totalGuards = 1;
+    bindings.hooks = hooks;
+    bindings.totalHooks = 1;
+    bindings.events = events;
+    bindings.totalEvents = 2;
+    bindings.sources = sources;
+    bindings.totalSources = 1;
+
+    auto buffer = new uint8_t[FSMImage::sizeFor(STATES, TRANSITIONS)];
+    const size_t size = writeImage(buffer);
+
+    FSMImage image;
+    unsigned long start = micros();
+    const bool loaded = image.load(buffer, size);
+    const unsigned long loadTime = micros() - start;
+
+    start = micros();
+    const bool verified = image.verify();
+    const unsigned long verifyTime = micros() - start;
+
+    ImageFSM fsm(image, bindings);
+    start = micros();
+    fsm.start();
+    for (unsigned long i = 0; i < STEPS; i++) {
+        fsm.run();
+    }
+    const unsigned long runTime = micros() - start;
+
+    Serial.print(F("Image: "));
+    Serial.print(size);
+    Serial.print(F(" bytes, "));
+    Serial.print(image.getTotalStates());
+    Serial.println(F(" states"));
+    Serial.print(F("load: "));
+    Serial.print(loaded ? F("ok, ") : F("failed, "));
+    Serial.print(loadTime);
+    Serial.println(F(" us"));
+    Serial.print(F("verify: "));
+    Serial.print(verified ? F("ok, ") : F("failed, "));
+    Serial.print(verifyTime);
+    Serial.println(F(" us"));
+    Serial.print(STEPS);
+    Serial.print(F(" steps: "));
+    Serial.print(runTime);
+    Serial.print(F(" us, "));
+    Serial.print(entered);
+    Serial.print(F(" states entered, now in state "));
+    Serial.println(fsm.getCurrentState());
+}
+
+void loop() {
+}
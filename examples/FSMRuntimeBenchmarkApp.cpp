@@ -0,0 +1,109 @@
+/**
+* Benchmark of FSMRuntime against calling run() on every FSM.
+ *
+ * Responsibilities:
+ * - Builds many FSMs that alternate between two timed states and also accept a posted command.
+ * - Simulates the same minute twice on the virtual clock: once stepping every FSM on every
+ *   loop, once through `FSMRuntime`, and compares steps, wall time and transitions.
+ *
+ * Design Considerations:
+ * - Timeouts between 0.5 and 5 s and one command per 10 ms keep the population mostly idle,
+ *   as in a real deployment.
+ */
+
+#include "fsm/FSMRuntime.h"
+#include "fsm/StateTimeoutTransition.h"
+#include "fsm/EventTransition.h"
+
+constexpr uint16_t MACHINES = 500;          ///< FSMs in the population.
+constexpr unsigned long DURATION = 60000;   ///< Simulated time in milliseconds.
+constexpr unsigned long COMMAND_PERIOD = 10;///< Time between posted commands in milliseconds.
+
+/**
+ * Counts transitions of every FSM.
+ */
+class TransitionCounter final : public TransitionObserver {
+public:
+    unsigned long count{0};
+
+    void onTransition(FSM* fsm, const State* from, const State* to, const Event* event) override {
+        count++;
+    }
+};
+
+/**
+ * Builds the population.
+ *
+ * @param fsms Receives the FSMs.
+ * @param counter Observer attached to every FSM.
+ */
+void build(FSM** fsms, TransitionCounter* counter) {
+    for (uint16_t i = 0; i < MACHINES; i++) {
+        auto queue = new EventQueue(4);
+        auto idle = new State(500 + (i * 37UL) % 4500);
+        auto active = new State(500 + (i * 53UL) % 4500);
+        idle->addTransition(new StateTimeoutTransition(active));
+        idle->addTransition(new EventTransition(active, Event::serialReceived, queue));
+        active->addTransition(new StateTimeoutTransition(idle));
+        fsms[i] = new FSM(idle);
+        fsms[i]->setQueue(queue)->setObserver(counter);
+    }
+}
+
+/**
+ * Prints one result.
+ *
+ * @param label Name of the configuration.
+ * @param steps Number of FSM steps.
+ * @param transitions Number of transitions.
+ * @param elapsed Wall time in microseconds.
+ */
+void report(const char* label, const unsigned long steps, const unsigned long transitions, const unsigned long elapsed) {
+    Serial.print(label);
+    Serial.print(F(": "));
+    Serial.print(steps);
+    Serial.print(F(" steps, "));
+    Serial.print(transitions);
+    Serial.print(F(" transitions, "));
+    Serial.print(elapsed / 1000UL);
+    Serial.println(F(" ms"));
+}
+
+void setup() {
+    Serial.begin(9600);
+    static FSM* fsms[MACHINES];
+
+    // Every FSM, every loop
+    TransitionCounter plainCounter;
+    build(fsms, &plainCounter);
+    Clock::useVirtual();
+    unsigned long start = micros();
+    unsigned long steps = 0;
+    for (uint16_t i = 0; i < MACHINES; i++) fsms[i]->start();
+    for (unsigned long t = 0; t < DURATION; t++) {
+        if (t % COMMAND_PERIOD == 0) fsms[(t / COMMAND_PERIOD) % MACHINES]->post(Event::serialReceived);
+        for (uint16_t i = 0; i < MACHINES; i++) fsms[i]->run();
+        steps += MACHINES;
+        Clock::advance(1);
+    }
+    report("Run all", steps, plainCounter.count, micros() - start);
+
+    // Ready set
+    TransitionCounter runtimeCounter;
+    build(fsms, &runtimeCounter);
+    FSMRuntime runtime(MACHINES);
+    for (uint16_t i = 0; i < MACHINES; i++) runtime.add(fsms[i]);
+    Clock::useVirtual();
+    start = micros();
+    runtime.start();
+    for (unsigned long t = 0; t < DURATION; t++) {
+        if (t % COMMAND_PERIOD == 0) runtime.post((t / COMMAND_PERIOD) % MACHINES, Event::serialReceived);
+        runtime.run();
+        Clock::advance(1);
+    }
+    report("FSMRuntime", runtime.getTotalSteps(), runtimeCounter.count, micros() - start);
+    Clock::useReal();
+}
+
+void loop() {
+}
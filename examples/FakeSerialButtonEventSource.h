@@ -20,9 +20,10 @@ public:
      *
      * @param charPressed Character representing a button press.
      * @param charReleased Character representing a button release.
+     * @param stream Port to read. Defaults to `Serial`.
      */
-    explicit FakeSerialButtonEventSource(const char charPressed, const char charReleased)
-        : expectedCharPressed{charPressed}, expectedCharReleased{charReleased} { }
+    explicit FakeSerialButtonEventSource(const char charPressed, const char charReleased, Stream& stream = Serial)
+        : SerialInterfaceEventSource(0, stream), expectedCharPressed{charPressed}, expectedCharReleased{charReleased} { }
 
     /**
      * Retrieves the current button event based on serial input.
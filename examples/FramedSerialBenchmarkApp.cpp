@@ -0,0 +1,119 @@
+/**
+ * Benchmark of FramedSerialEventSource against byte-per-tick serial parsing.
+ *
+ * Responsibilities:
+ * - Feeds the same stream of newline-terminated commands to both sources at 115200 baud,
+ *   about 12 bytes per 1 ms loop.
+ * - Parses it once with `SerialInterfaceEventSource`, one byte per loop, and once with
+ *   `FramedSerialEventSource`, which drains the port on every loop.
+ * - Reports the loops needed to parse every command, the worst backlog and the wall time.
+ *
+ * Design Considerations:
+ * - `PacedStream` releases a fixed number of bytes per loop, like a UART receive buffer.
+ */
+
+#include "events/SerialInterfaceEventSource.h"
+#include "events/FramedSerialEventSource.h"
+
+constexpr uint16_t COMMANDS = 1000;         ///< Commands in the stream.
+constexpr uint8_t BYTES_PER_LOOP = 12;      ///< Bytes arriving per 1 ms loop at 115200 baud.
+
+/**
+ * Stream over a memory buffer that releases `BYTES_PER_LOOP` bytes per `tick`.
+ */
+class PacedStream final : public Stream {
+    const uint8_t* data;
+    size_t length;
+    size_t arrived{0};
+    size_t position{0};
+
+public:
+    PacedStream(const uint8_t* bytes, const size_t size) : data{bytes}, length{size} { }
+
+    void tick() { arrived = arrived + BYTES_PER_LOOP < length ? arrived + BYTES_PER_LOOP : length; }
+    bool isDone() const { return arrived == length; }
+    size_t getBacklog() const { return arrived - position; }
+
+    int available() override { return static_cast<int>(arrived - position); }
+    int read() override { return position < arrived ? data[position++] : -1; }
+    int peek() override { return position < arrived ? data[position] : -1; }
+    size_t write(uint8_t) override { return 0; }
+};
+
+/**
+ * Prints one result.
+ *
+ * @param label Name of the configuration.
+ * @param parsed Commands parsed.
+ * @param loops Loops needed.
+ * @param backlog Largest number of unread bytes.
+ * @param elapsed Wall time in microseconds.
+ */
+void report(const char* label, const unsigned long parsed, const unsigned long loops,
+            const size_t backlog, const unsigned long elapsed) {
+    Serial.print(label);
+    Serial.print(F(": "));
+    Serial.print(parsed);
+    Serial.print(F(" commands in "));
+    Serial.print(loops);
+    Serial.print(F(" loops, backlog "));
+    Serial.print(backlog);
+    Serial.print(F(" bytes, "));
+    Serial.print(elapsed);
+    Serial.println(F(" us"));
+}
+
+void setup() {
+    Serial.begin(9600);
+    static uint8_t stream[COMMANDS * 20];
+    size_t length = 0;
+    for (uint16_t i = 0; i < COMMANDS; i++) {
+        length += snprintf(reinterpret_cast<char*>(stream + length), 20, "SET %5u %5u\n", i, COMMANDS - i);
+    }
+
+    // One byte per loop, assembled by the application
+    PacedStream bytewise(stream, length);
+    SerialInterfaceEventSource bytes(0, bytewise);
+    char line[32];
+    uint8_t lineLength = 0;
+    unsigned long parsed = 0;
+    unsigned long loops = 0;
+    size_t backlog = 0;
+    unsigned long start = micros();
+    while (parsed < COMMANDS) {
+        bytewise.tick();
+        const Event* event = bytes.getEvent();
+        if (event != Event::none) {
+            const char c = static_cast<char>(event->getIntValue());
+            if (c == '\n') {
+                parsed++;
+                lineLength = 0;
+            } else if (lineLength < sizeof(line)) {
+                line[lineLength++] = c;
+            }
+        }
+        if (bytewise.getBacklog() > backlog) backlog = bytewise.getBacklog();
+        loops++;
+    }
+    report("Byte per loop", parsed, loops, backlog, micros() - start);
+
+    // Bulk drain, one frame per event
+    PacedStream framed(stream, length);
+    FramedSerialEventSource frames(Framing::DELIMITED, 64, framed);
+    parsed = 0;
+    loops = 0;
+    backlog = 0;
+    start = micros();
+    while (parsed < COMMANDS) {
+        framed.tick();
+        while (frames.getEvent() != Event::none) {
+            parsed++;
+        }
+        if (framed.getBacklog() > backlog) backlog = framed.getBacklog();
+        loops++;
+    }
+    report("Framed", parsed, loops, backlog, micros() - start);
+}
+
+void loop() {
+}
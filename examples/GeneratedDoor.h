@@ -0,0 +1,170 @@
+/**
+ * GeneratedDoor: state machine generated by tools/fsmgen.py. Do not edit; regenerate instead.
+ *
+ * Guards and hooks are declared here and defined by the application in GeneratedDoorHooks.cpp.
+ */
+
+#ifndef GENERATED_DOOR_H
+#define GENERATED_DOOR_H
+
+#include <Arduino.h>
+#include "actions/Clock.h"
+#include "events/Event.h"
+
+/**
+ * @brief Switch-based GeneratedDoor state machine
+ *
+ * Usage:
+ * @code
+ * GeneratedDoor machine;
+ * machine.start();
+ *
+ * void loop() {
+ *     machine.run(source->getEvent());
+ * }
+ * @endcode
+ */
+class GeneratedDoor {
+public:
+    /**
+     * States of the machine.
+     */
+    enum class StateId : uint8_t {
+        LOCKED,
+        UNLOCKED,
+        OPENING,
+        OPEN,
+        CLOSING,
+    };
+
+    Event lockRequested{EventType::EVENT_CUSTOM}; ///< Custom event `lockRequested`.
+
+    /**
+     * Enters the initial state, locked, and starts running.
+     */
+    void start() {
+        running = true;
+        enter(StateId::LOCKED, nullptr);
+    }
+
+    /**
+     * Stops the machine, staying in the current state.
+     */
+    void stop() { running = false; }
+
+    /**
+     * Executes one update cycle: takes the first triggered transition of the
+     * current state, or calls its update hook if none is triggered.
+     *
+     * @param event The event presented to event transitions, or `nullptr`.
+     * @return `true` if the machine changed state, `false` otherwise.
+     */
+    bool run(Event* event = nullptr) {
+        if (!running) return false;
+        const unsigned long elapsed = Clock::now() - enteredAt;
+        switch (currentState) {
+            case StateId::LOCKED:
+                // event transition to unlocked
+                if (event == Event::buttonPressed) {
+                    enter(StateId::UNLOCKED, event);
+                    return true;
+                }
+                break;
+            case StateId::UNLOCKED:
+                // event transition to opening
+                if (event == Event::buttonPressed) {
+                    enter(StateId::OPENING, event);
+                    return true;
+                }
+                // event transition to locked
+                if (event == &lockRequested) {
+                    enter(StateId::LOCKED, event);
+                    return true;
+                }
+                // timeout transition to locked
+                if (elapsed >= 10000UL) {
+                    enter(StateId::LOCKED, Event::none);
+                    return true;
+                }
+                break;
+            case StateId::OPENING:
+                // timeout transition to open
+                if (elapsed >= 3000UL) {
+                    onExitOpening(Event::none);
+                    enter(StateId::OPEN, Event::none);
+                    return true;
+                }
+                break;
+            case StateId::OPEN:
+                // timeout transition to closing
+                if (elapsed >= 5000UL) {
+                    enter(StateId::CLOSING, Event::none);
+                    return true;
+                }
+                break;
+            case StateId::CLOSING:
+                // priority transition to opening on the event
+                if (event == Event::buttonPressed) {
+                    onExitClosing(event);
+                    enter(StateId::OPENING, event);
+                    return true;
+                }
+                // condition transition to opening
+                if (obstacleDetected()) {
+                    onExitClosing(Event::none);
+                    enter(StateId::OPENING, Event::none);
+                    return true;
+                }
+                // timeout transition to locked
+                if (elapsed >= 3000UL) {
+                    onExitClosing(Event::none);
+                    enter(StateId::LOCKED, Event::none);
+                    return true;
+                }
+                break;
+        }
+        (void) event;
+        (void) elapsed;
+        return false;
+    }
+
+    /**
+     * Retrieves the current state.
+     *
+     * @return The current state.
+     */
+    StateId getCurrentState() const { return currentState; }
+
+    /**
+     * Checks whether the machine is running.
+     *
+     * @return `true` once started and until stopped.
+     */
+    bool isRunning() const { return running; }
+
+private:
+    StateId currentState{StateId::LOCKED}; ///< The current state.
+    unsigned long enteredAt{0}; ///< Time the current state was entered, in ms.
+    bool running{false}; ///< Whether the machine is running.
+
+    void enter(const StateId next, Event* event) {
+        currentState = next;
+        enteredAt = Clock::now();
+        switch (next) {
+            case StateId::LOCKED: onEnterLocked(event); break;
+            case StateId::OPENING: onEnterOpening(event); break;
+            case StateId::CLOSING: onEnterClosing(event); break;
+            default: break;
+        }
+    }
+
+    // Guards and hooks, defined in GeneratedDoorHooks.cpp.
+    bool obstacleDetected();
+    void onEnterLocked(Event* event);
+    void onEnterOpening(Event* event);
+    void onExitOpening(Event* event);
+    void onEnterClosing(Event* event);
+    void onExitClosing(Event* event);
+};
+
+#endif //GENERATED_DOOR_H
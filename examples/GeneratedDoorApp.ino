@@ -0,0 +1,34 @@
+/**
+ * Automated door running the code generated from GeneratedDoor.scxml.
+ *
+ * Compare with SimpleDoorControllerApp.ino: the same kind of door, but its states
+ * are an enum and its transitions a switch, with no virtual call and no heap.
+ * Regenerate GeneratedDoor.h with:
+ *     tools/fsmgen.py examples/GeneratedDoor.scxml -o examples/
+ */
+
+#include "GeneratedDoor.h"
+#include "events/RawButtonEventSource.h"
+
+constexpr uint8_t BUTTON_PIN = 2;         ///< Unlocks, then opens the door.
+constexpr uint8_t LOCK_BUTTON_PIN = 3;    ///< Locks the door while unlocked.
+
+GeneratedDoor door;
+RawButtonEventSource button(BUTTON_PIN);
+
+void setupDoorPins();                     // in GeneratedDoorHooks.cpp
+
+void setup() {
+    Serial.begin(9600);
+    pinMode(BUTTON_PIN, INPUT_PULLUP);
+    pinMode(LOCK_BUTTON_PIN, INPUT_PULLUP);
+    setupDoorPins();
+    door.start();
+}
+
+void loop() {
+    if (digitalRead(LOCK_BUTTON_PIN) == LOW) {
+        door.run(&door.lockRequested);
+    }
+    door.run(button.getEvent());
+}
@@ -0,0 +1,54 @@
+/**
+ * Guards and hooks of GeneratedDoor. Generated once by tools/fsmgen.py; edit freely.
+ */
+
+#include "GeneratedDoor.h"
+
+constexpr uint8_t LOCK_LED_PIN = 13;      ///< On while the door is locked.
+constexpr uint8_t MOTOR_PIN = 5;          ///< Drives the door motor.
+constexpr uint8_t OBSTACLE_PIN = 4;       ///< Low while the light barrier is interrupted.
+
+/**
+ * Configures the pins used by the hooks.
+ */
+void setupDoorPins() {
+    pinMode(LOCK_LED_PIN, OUTPUT);
+    pinMode(MOTOR_PIN, OUTPUT);
+    pinMode(OBSTACLE_PIN, INPUT_PULLUP);
+}
+
+/**
+ * Guard `obstacleDetected`.
+ */
+bool GeneratedDoor::obstacleDetected() {
+    return digitalRead(OBSTACLE_PIN) == LOW;
+}
+
+void GeneratedDoor::onEnterLocked(Event* event) {
+    (void) event;
+    Serial.println(F("Door is now LOCKED"));
+    digitalWrite(LOCK_LED_PIN, HIGH);
+}
+
+void GeneratedDoor::onEnterOpening(Event* event) {
+    (void) event;
+    Serial.println(F("Door is OPENING..."));
+    digitalWrite(LOCK_LED_PIN, LOW);
+    digitalWrite(MOTOR_PIN, HIGH);
+}
+
+void GeneratedDoor::onExitOpening(Event* event) {
+    (void) event;
+    digitalWrite(MOTOR_PIN, LOW);
+}
+
+void GeneratedDoor::onEnterClosing(Event* event) {
+    (void) event;
+    Serial.println(F("Door is CLOSING..."));
+    digitalWrite(MOTOR_PIN, HIGH);
+}
+
+void GeneratedDoor::onExitClosing(Event* event) {
+    (void) event;
+    digitalWrite(MOTOR_PIN, LOW);
+}
@@ -15,6 +15,7 @@ class SerialButtonTimeoutEventSource final : public BaseEventSource {
     AlarmTimer* serialTimer; ///< Timer for managing serial input timeout.
     bool waitingTimeout{false}; ///< Indicates if a timeout is active.
     const int expectedChar; ///< Character expected to trigger an event.
+    Stream& port; ///< Serial port read by this source.
 
 public:
     /**
@@ -22,9 +23,10 @@ public:
      *
      * @param charReceived Character to monitor for input.
      * @param timeout Timeout duration in milliseconds.
+     * @param stream Port to read. Defaults to `Serial`.
      */
-    SerialButtonTimeoutEventSource(const int charReceived, const unsigned long timeout)
-        : serialTimer{new AlarmTimer(timeout)}, expectedChar{charReceived} { }
+    SerialButtonTimeoutEventSource(const int charReceived, const unsigned long timeout, Stream& stream = Serial)
+        : serialTimer{new AlarmTimer(timeout)}, expectedChar{charReceived}, port{stream} { }
 
     /**
      * Retrieves the current serial event or timeout event.
@@ -43,8 +45,8 @@ public:
             return Event::none;
         }
 
-        if (Serial.available() > 0) {
-            const int received = Serial.read();
+        if (port.available() > 0) {
+            const int received = port.read();
             if (received == expectedChar) {
                 waitingTimeout = true;
                 serialTimer->start();
@@ -0,0 +1,88 @@
+/**
+* Benchmark of FSM and PeriodicAction snapshots.
+ *
+ * Responsibilities:
+ * - Measures the average cost of `snapshot` and `restore` over many iterations.
+ * - Prints the size of each encoding.
+ *
+ * Design Considerations:
+ * - Uses the LED states from `blink.h` and `ActionBlinkLed`; results are printed once in `setup`.
+ */
+
+#include "blink.h"
+#include "ActionBlinkLed.h"
+#include "fsm/FSM.h"
+#include "fsm/StateTimeoutTransition.h"
+
+constexpr unsigned long ITERATIONS = 10000; ///< Operations per measurement.
+
+auto stateOn = new LedOnState(3000); ///< State for LED ON.
+auto stateOff = new LedOffState(1000); ///< State for LED OFF.
+auto fsm = new FSM(stateOn); ///< FSM under test.
+auto blinkAction = new ActionBlinkLed(LED_PIN, 500); ///< Periodic action under test.
+
+/**
+ * Prints one benchmark result.
+ *
+ * @param label Name of the measured operation.
+ * @param elapsed Total time in microseconds.
+ * @param bytes Size of the encoding in bytes.
+ */
+void report(const char* label, const unsigned long elapsed, const size_t bytes) {
+    Serial.print(label);
+    Serial.print(F(": "));
+    Serial.print(elapsed * 1000UL / ITERATIONS);
+    Serial.print(F(" ns/op, "));
+    Serial.print(static_cast<unsigned long>(bytes));
+    Serial.println(F(" bytes"));
+}
+
+void setup() {
+    Serial.begin(9600);
+    pinMode(LED_PIN, OUTPUT);
+
+    stateOn->addTransition(new StateTimeoutTransition(stateOff));
+    stateOff->addTransition(new StateTimeoutTransition(stateOn));
+    fsm->start();
+    blinkAction->execute();
+
+    uint8_t fsmBuffer[FSM::SNAPSHOT_MAX_SIZE];
+    uint8_t actionBuffer[PeriodicAction::SNAPSHOT_MAX_SIZE];
+    size_t fsmSize = 0;
+    size_t actionSize = 0;
+
+    unsigned long start = micros();
+    for (unsigned long i = 0; i < ITERATIONS; i++) {
+        fsmSize = fsm->snapshot(fsmBuffer, sizeof(fsmBuffer));
+    }
+    report("FSM snapshot", micros() - start, fsmSize);
+
+    start = micros();
+    for (unsigned long i = 0; i < ITERATIONS; i++) {
+        fsm->restore(fsmBuffer, fsmSize, false);
+    }
+    report("FSM restore", micros() - start, fsmSize);
+
+    start = micros();
+    for (unsigned long i = 0; i < ITERATIONS; i++) {
+        fsm->restore(fsmBuffer, fsmSize);
+    }
+    report("FSM restore + onEnter", micros() - start, fsmSize);
+
+    start = micros();
+    for (unsigned long i = 0; i < ITERATIONS; i++) {
+        actionSize = blinkAction->snapshot(actionBuffer, sizeof(actionBuffer));
+    }
+    report("PeriodicAction snapshot", micros() - start, actionSize);
+
+    start = micros();
+    for (unsigned long i = 0; i < ITERATIONS; i++) {
+        blinkAction->restore(actionBuffer, actionSize);
+    }
+    report("PeriodicAction restore", micros() - start, actionSize);
+}
+
+void loop() {
+    fsm->run();
+    blinkAction->execute();
+}
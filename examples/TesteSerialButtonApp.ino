@@ -4,6 +4,7 @@
 #include "fsm/EventTransition.h"
 #include "fsm/FSM.h"
 #include "FakeSerialButtonEventSource.h"
+#include "events/SerialDemux.h"
 #include "fsm/State.h"
 #include "fsm/StateTimeoutTransition.h"
 #include "fsm/ImmediateTransition.h"
@@ -88,9 +89,10 @@ public:
    }
 };
 
-// Event Sources (with no timeout)
-auto eventSourceA = new FakeSerialButtonEventSource('A', 'S');
-auto eventSourceL = new FakeSerialButtonEventSource('L', 'K');
+// Event Sources (with no timeout), sharing the serial port through one reader
+auto serialDemux = new SerialDemux(2);
+auto eventSourceA = new FakeSerialButtonEventSource('A', 'S', *serialDemux->addChannel("AS"));
+auto eventSourceL = new FakeSerialButtonEventSource('L', 'K', *serialDemux->addChannel("LK"));
 
 // Global states
 auto s0 = new State0();
@@ -0,0 +1,69 @@
+/**
+ * Benchmark of millisecond against microsecond `AlarmTimer`s at high rates.
+ *
+ * Responsibilities:
+ * - Drives one periodic timer at 1, 5 and 20 kHz, first in milliseconds, then in
+ *   microseconds, from a tight loop.
+ * - Timestamps every trigger with `micros()` and reports the achieved rate and the
+ *   mean and worst deviation of the intervals from the requested period.
+ *
+ * Design Considerations:
+ * - A millisecond timer cannot express periods under 1 ms, so it runs with the
+ *   closest period it has, 1 ms; the achieved rate shows what is lost.
+ * - The loop does nothing else, so the figures are the timer's own jitter.
+ */
+
+#include "actions/AlarmTimer.h"
+
+constexpr unsigned long DURATION = 500000;           ///< Measurement time per run in microseconds.
+constexpr unsigned long RATES[] = { 1000, 5000, 20000 }; ///< Requested rates in Hz.
+
+/**
+ * Runs one timer and prints its figures.
+ *
+ * @param rate Requested rate in Hz.
+ * @param unit Resolution of the timer.
+ */
+void measure(const unsigned long rate, const TimeUnit unit) {
+    const unsigned long period = 1000000UL / rate;
+    const unsigned long duration = unit == TimeUnit::MICROSECONDS ? period
+                                   : period >= 1000UL ? period / 1000UL : 1UL;
+    AlarmTimer timer(duration, unit);
+
+    unsigned long ticks = 0;
+    unsigned long totalDeviation = 0;
+    unsigned long worstDeviation = 0;
+    const unsigned long start = micros();
+    unsigned long last = start;
+    timer.start();
+    while (micros() - start < DURATION) {
+        if (!timer.elapsed()) continue;
+        const unsigned long now = micros();
+        const unsigned long interval = now - last;
+        const unsigned long deviation = interval > period ? interval - period : period - interval;
+        last = now;
+        if (ticks++ == 0) continue;
+        totalDeviation += deviation;
+        if (deviation > worstDeviation) worstDeviation = deviation;
+    }
+
+    Serial.print(rate);
+    Serial.print(unit == TimeUnit::MICROSECONDS ? F(" Hz, us timer: ") : F(" Hz, ms timer: "));
+    Serial.print(ticks * 1000000UL / DURATION);
+    Serial.print(F(" Hz achieved, jitter mean "));
+    Serial.print(ticks > 1 ? totalDeviation / (ticks - 1) : 0);
+    Serial.print(F(" us, worst "));
+    Serial.print(worstDeviation);
+    Serial.println(F(" us"));
+}
+
+void setup() {
+    Serial.begin(115200);
+    for (const unsigned long rate : RATES) {
+        measure(rate, TimeUnit::MILLISECONDS);
+        measure(rate, TimeUnit::MICROSECONDS);
+    }
+}
+
+void loop() {
+}
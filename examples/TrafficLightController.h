@@ -9,6 +9,7 @@
 #include "fsm/StateTimeoutTransition.h"
 #include "fsm/EventTransition.h"
 #include "fsm/ConditionTransition.h"
+#include "actions/CallbackAction.h"
 #include "DebouncedButtonEventSource.h"
 
 // Pin definitions
@@ -38,7 +39,7 @@ class EmergencyState;
 // Base state with common functionality
 class TrafficLightState: public State {
 protected:
-    AlarmTimer* stateTimer{nullptr};
+    explicit TrafficLightState(unsigned long duration = 0): State(duration) {}
 
     void turnOffAllLights() const {
         digitalWrite(RED_PIN, LOW);
@@ -50,10 +51,7 @@ protected:
 // Red light state
 class RedState final: public TrafficLightState {
 public:
-    explicit RedState(unsigned long duration = RED_DURATION): TrafficLightState() {
-        // Initialize the state with the specified duration
-        stateTimer = new AlarmTimer(duration);
-    }
+    explicit RedState(unsigned long duration = RED_DURATION): TrafficLightState(duration) {}
 
     void onEnter(Event* event) const override {
         turnOffAllLights();
@@ -69,31 +67,22 @@ public:
 
 // Yellow light state with blinking capability
 class YellowState final: public TrafficLightState {
-    bool isBlinking;
-    AlarmTimer* blinkTimer;
-
 public:
     explicit YellowState(unsigned long duration = YELLOW_DURATION, bool blink = false):
-        TrafficLightState(), isBlinking(blink) {
-        stateTimer = new AlarmTimer(duration);
-        blinkTimer = new AlarmTimer(BLINK_INTERVAL);
+        TrafficLightState(duration) {
+        if (blink) {
+            addAction(new PeriodicCallbackAction(BLINK_INTERVAL, BLINK_INTERVAL, -1, [] {
+                digitalWrite(YELLOW_PIN, !digitalRead(YELLOW_PIN));
+            }));
+        }
     }
 
     void onEnter(Event* event) const override {
         turnOffAllLights();
         digitalWrite(YELLOW_PIN, HIGH);
-        if (isBlinking) {
-            blinkTimer->start();
-        }
         State::onEnter(event);
     }
 
-    void onUpdate() const override {
-        if (isBlinking && blinkTimer->elapsed()) {
-            digitalWrite(YELLOW_PIN, !digitalRead(YELLOW_PIN));
-        }
-    }
-
     void onExit(Event* event) const override {
         digitalWrite(YELLOW_PIN, LOW);
         State::onExit(event);
@@ -106,9 +95,7 @@ class GreenState final: public TrafficLightState {
 
 public:
     explicit GreenState(unsigned long duration = GREEN_DURATION):
-        TrafficLightState(), pedestrianWaiting(false) {
-        stateTimer = new AlarmTimer(duration);
-    }
+        TrafficLightState(duration), pedestrianWaiting(false) {}
 
     void onEnter(Event* event) const override {
         turnOffAllLights();
@@ -124,25 +111,18 @@ public:
 
 // Emergency state (flashing red)
 class EmergencyState final: public TrafficLightState {
-    AlarmTimer* blinkTimer;
-
 public:
     explicit EmergencyState(): TrafficLightState() {
-        blinkTimer = new AlarmTimer(BLINK_INTERVAL);
+        addAction(new PeriodicCallbackAction(BLINK_INTERVAL, BLINK_INTERVAL, -1, [] {
+            digitalWrite(RED_PIN, !digitalRead(RED_PIN));
+        }));
     }
 
     void onEnter(Event* event) const override {
         turnOffAllLights();
-        blinkTimer->start();
         State::onEnter(event);
     }
 
-    void onUpdate() const override {
-        if (blinkTimer->elapsed()) {
-            digitalWrite(RED_PIN, !digitalRead(RED_PIN));
-        }
-    }
-
     void onExit(Event* event) const override {
         digitalWrite(RED_PIN, LOW);
         State::onExit(event);
@@ -160,7 +140,8 @@ class TrafficLightController {
     EmergencyState* emergencyState;
 
 public:
-    TrafficLightController() {
+    TrafficLightController(BaseEventSource* pedestrian = pedestrianButton,
+                           BaseEventSource* emergency = emergencyButton) {
         // Create states
         redState = new RedState();
         yellowState = new YellowState();
@@ -176,31 +157,31 @@ public:
         redState->addTransition(new EventTransition(
             emergencyState,
             Event::buttonPressed,
-            emergencyButton
+            emergency
         ));
         yellowState->addTransition(new EventTransition(
             emergencyState,
             Event::buttonPressed,
-            emergencyButton
+            emergency
         ));
         greenState->addTransition(new EventTransition(
             emergencyState,
             Event::buttonPressed,
-            emergencyButton
+            emergency
         ));
 
         // Add pedestrian button transition (shortens green duration)
         greenState->addTransition(new EventTransition(
             yellowState,
             Event::buttonPressed,
-            pedestrianButton
+            pedestrian
         ));
 
         // Return from emergency transition
         emergencyState->addTransition(new EventTransition(
             redState,
             Event::buttonPressed,
-            emergencyButton
+            emergency
         ));
 
         // Initialize FSM with red state
@@ -222,6 +203,10 @@ public:
     void update() {
         fsm->run();
     }
+
+    FSM* getFSM() const {
+        return fsm;
+    }
 };
 
 
@@ -0,0 +1,114 @@
+/**
+* Benchmark of the write-ahead transition log on a POSIX host.
+ *
+ * Responsibilities:
+ * - Drives several FSMs that change state on every `run()`.
+ * - Prints transitions per second without a log, with group commit and with a sync per record.
+ * - Checks that `recover` restores every FSM from the log it just wrote.
+ *
+ * Design Considerations:
+ * - Two plain states linked by `ImmediateTransition`s, so the FSM itself costs almost nothing
+ *   and the measurement is dominated by the log.
+ */
+
+#include "fsm/FSM.h"
+#include "fsm/ImmediateTransition.h"
+#include "fsm/TransitionLog.h"
+
+#include <unistd.h>
+
+constexpr uint16_t MACHINES = 8;              ///< FSMs attached to the log.
+constexpr unsigned long TRANSITIONS = 20000;  ///< Transitions per measurement.
+
+FSM* machines[MACHINES]; ///< FSMs under test.
+
+/**
+ * Runs every FSM round-robin until the requested number of transitions happened.
+ *
+ * @param log Log to poll, or `nullptr` to run without one.
+ * @param count Number of transitions.
+ * @return Elapsed time in microseconds.
+ */
+unsigned long drive(TransitionLog* log, const unsigned long count) {
+    const unsigned long start = micros();
+    for (unsigned long i = 0; i < count; i++) {
+        machines[i % MACHINES]->run();
+        if (log) log->poll();
+    }
+    if (log) log->commit();
+    return micros() - start;
+}
+
+/**
+ * Prints one benchmark result.
+ *
+ * @param label Name of the configuration.
+ * @param count Number of transitions.
+ * @param elapsed Total time in microseconds.
+ * @param log Log used, or `nullptr`.
+ */
+void report(const char* label, const unsigned long count, const unsigned long elapsed, const TransitionLog* log) {
+    Serial.print(label);
+    Serial.print(F(": "));
+    Serial.print(static_cast<unsigned long>(count * 1000000.0 / (elapsed ? elapsed : 1)));
+    Serial.print(F(" transitions/s"));
+    if (log) {
+        Serial.print(F(", "));
+        Serial.print(log->getTotalCommits());
+        Serial.print(F(" syncs"));
+    }
+    Serial.println();
+}
+
+/**
+ * Measures one group-commit setting with a fresh log.
+ *
+ * @param label Name of the configuration.
+ * @param records Records per commit.
+ * @param count Number of transitions.
+ */
+void measure(const char* label, const uint16_t records, const unsigned long count) {
+    unlink("bench.log");
+    unlink("bench.snap");
+    TransitionLog log("bench.log", "bench.snap");
+    log.setGroupCommit(records, 10);
+    for (uint16_t i = 0; i < MACHINES; i++) {
+        log.attach(machines[i], i);
+    }
+    log.open();
+    report(label, count, drive(&log, count), &log);
+    log.close();
+
+    for (uint16_t i = 0; i < MACHINES; i++) {
+        machines[i]->stop();
+    }
+    log.open();
+    Serial.print(F("  recovered "));
+    Serial.print(log.recover());
+    Serial.print(F(" of "));
+    Serial.println(MACHINES);
+}
+
+void setup() {
+    Serial.begin(9600);
+
+    for (uint16_t i = 0; i < MACHINES; i++) {
+        auto ping = new State();
+        auto pong = new State();
+        ping->addTransition(new ImmediateTransition(pong));
+        pong->addTransition(new ImmediateTransition(ping));
+        machines[i] = new FSM(ping);
+        machines[i]->start();
+    }
+
+    report("No log", TRANSITIONS, drive(nullptr, TRANSITIONS), nullptr);
+    measure("Group commit (64)", 64, TRANSITIONS);
+    measure("Group commit (8)", 8, TRANSITIONS);
+    measure("Sync per record", 1, TRANSITIONS / 10);
+
+    unlink("bench.log");
+    unlink("bench.snap");
+}
+
+void loop() {
+}
@@ -0,0 +1,172 @@
+/**
+ * Crash-recovery check of the write-ahead transition log on a POSIX host.
+ *
+ * Responsibilities:
+ * - Writes a log from a child process, raising the group-commit size after `open`,
+ *   and kills the child with SIGKILL while a batch is still uncommitted.
+ * - Recovers the log in the parent and checks that every FSM is back in the state
+ *   it had at the child's last commit.
+ * - Logs to /dev/full and checks that failed commits are reported and kept for
+ *   retry instead of being silently dropped.
+ *
+ * Design Considerations:
+ * - Each FSM is a ring of states linked by `ImmediateTransition`s, so its state
+ *   index after n runs is n modulo the ring size and is easy to compare.
+ * - Prints PASS or FAIL per check and exits with the number of failures.
+ */
+
+#include "fsm/FSM.h"
+#include "fsm/ImmediateTransition.h"
+#include "fsm/TransitionLog.h"
+
+#include <signal.h>
+#include <stdlib.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+constexpr uint16_t MACHINES = 4;      ///< FSMs attached to the log.
+constexpr uint8_t RING = 5;           ///< States per FSM.
+constexpr uint16_t COMMITTED = 700;   ///< Transitions made and committed before the crash.
+constexpr uint16_t LOST = 30;         ///< Transitions made after the last commit.
+
+int failures = 0;                     ///< Failed checks.
+
+/**
+ * Builds an FSM whose states form a ring of immediate transitions.
+ *
+ * @return The FSM, started.
+ */
+FSM* makeRing() {
+    State* states[RING];
+    for (auto& state : states) {
+        state = new State();
+    }
+    for (uint8_t i = 0; i < RING; i++) {
+        states[i]->addTransition(new ImmediateTransition(states[(i + 1) % RING]));
+    }
+    auto fsm = new FSM(states[0]);
+    fsm->start();
+    return fsm;
+}
+
+/**
+ * Prints the result of one check.
+ *
+ * @param label What was checked.
+ * @param passed Whether the check held.
+ */
+void check(const char* label, const bool passed) {
+    Serial.print(passed ? F("PASS ") : F("FAIL "));
+    Serial.println(label);
+    if (!passed) failures++;
+}
+
+/**
+ * Writes the log and dies without closing it. Runs in the child process.
+ *
+ * @param report Pipe receiving the state indices at the last commit.
+ */
+void writeAndCrash(const int report) {
+    FSM* machines[MACHINES];
+    TransitionLog log("recovery.log", "recovery.snap");
+    log.setCompaction(500);
+    for (uint16_t i = 0; i < MACHINES; i++) {
+        machines[i] = makeRing();
+        log.attach(machines[i], i);
+    }
+    log.open();
+    // Larger batches than the buffer sized by `open`: applies only from the next `open`
+    log.setGroupCommit(1000, 100000);
+
+    for (uint16_t n = 0; n < COMMITTED; n++) {
+        machines[n % MACHINES]->run();
+    }
+    log.commit();
+    uint8_t states[MACHINES];
+    for (uint16_t i = 0; i < MACHINES; i++) {
+        states[i] = static_cast<uint8_t>(machines[i]->indexOf(machines[i]->getCurrentState()));
+    }
+    write(report, states, sizeof(states));
+
+    for (uint16_t n = 0; n < LOST; n++) {
+        machines[n % MACHINES]->run();
+    }
+    kill(getpid(), SIGKILL);
+}
+
+/**
+ * Crashes a writer and recovers its log.
+ */
+void checkRecovery() {
+    unlink("recovery.log");
+    unlink("recovery.snap");
+    int report[2];
+    if (pipe(report) != 0) {
+        check("pipe", false);
+        return;
+    }
+
+    const pid_t child = fork();
+    if (child == 0) {
+        close(report[0]);
+        writeAndCrash(report[1]);
+        _exit(0);
+    }
+    close(report[1]);
+    uint8_t expected[MACHINES] = {};
+    const bool received = read(report[0], expected, sizeof(expected)) == sizeof(expected);
+    close(report[0]);
+    int status = 0;
+    waitpid(child, &status, 0);
+    check("writer killed by SIGKILL", WIFSIGNALED(status) && WTERMSIG(status) == SIGKILL);
+    check("writer reported its committed states", received);
+
+    FSM* machines[MACHINES];
+    TransitionLog log("recovery.log", "recovery.snap");
+    for (uint16_t i = 0; i < MACHINES; i++) {
+        machines[i] = makeRing();
+        machines[i]->stop();
+        log.attach(machines[i], i);
+    }
+    log.open();
+    check("every FSM recovered", log.recover() == MACHINES);
+    bool same = true;
+    for (uint16_t i = 0; i < MACHINES; i++) {
+        same = same && machines[i]->indexOf(machines[i]->getCurrentState()) == expected[i];
+    }
+    check("recovered states match the last commit", same);
+    log.close();
+    unlink("recovery.log");
+    unlink("recovery.snap");
+}
+
+/**
+ * Logs to a device that fails every write.
+ */
+void checkWriteErrors() {
+    FSM* fsm = makeRing();
+    TransitionLog log("/dev/full", "recovery.snap");
+    log.setGroupCommit(4, 100000);
+    log.attach(fsm, 0);
+    if (!log.open()) {
+        Serial.println(F("SKIP /dev/full not available"));
+        return;
+    }
+    for (uint8_t n = 0; n < 4; n++) {
+        fsm->run();
+    }
+    check("failed commit is counted", log.getTotalErrors() > 0 && log.getTotalRecords() == 0);
+    check("failed batch is kept for retry", !log.commit() && log.getDroppedRecords() == 0);
+    fsm->run();
+    check("records beyond a full failed batch are counted as dropped", log.getDroppedRecords() == 1);
+}
+
+void setup() {
+    Serial.begin(9600);
+    checkRecovery();
+    checkWriteErrors();
+    exit(failures);
+}
+
+void loop() {
+}
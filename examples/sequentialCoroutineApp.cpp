@@ -0,0 +1,50 @@
+/**
+ * The `sequential` example written as a single coroutine state.
+ *
+ * Responsibilities:
+ * - Lights LED1, LED2 and LED3 in turn for one second each, forever.
+ * - Needs no state per LED and no timeout transitions: the sequence is the body
+ *   of `LedSequence::behave`.
+ *
+ * Design Considerations:
+ * - Requires a toolchain with C++20 coroutines (see `CoroutineState.h`).
+ */
+
+#include "fsm/FSM.h"
+#include "fsm/CoroutineState.h"
+
+constexpr uint8_t LED1 = LED_BUILTIN_TX; ///< 30: Pin number for the LED TX.
+constexpr uint8_t LED2 = LED_BUILTIN_RX; ///< 17: Pin number for the LED RX.
+constexpr uint8_t LED3 = LED_BUILTIN ;   ///< 13: Pin number for the LED TBUILTIN..
+
+class LedSequence final : public CoroutineState {
+    fsm::Behavior behave() override {
+        static const uint8_t leds[] = { LED1, LED2, LED3 };
+        while (true) {
+            for (const uint8_t pin : leds) {
+                digitalWrite(pin, HIGH);
+                co_await fsm::delay(1000);
+                digitalWrite(pin, LOW);
+            }
+        }
+    }
+
+public:
+    LedSequence() {
+        pinMode(LED1, OUTPUT);
+        pinMode(LED2, OUTPUT);
+        pinMode(LED3, OUTPUT);
+    }
+};
+
+FSM* seqFsm = nullptr;
+
+void setup() {
+    Serial.begin(9600);
+    seqFsm = new FSM(new LedSequence());
+    seqFsm->start();
+}
+
+void loop() {
+    seqFsm->run();
+}
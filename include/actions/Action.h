@@ -5,6 +5,10 @@
 #ifndef ACTION_H
 #define ACTION_H
 
+#include <Arduino.h>
+
+class ExecutionStats;
+
 /**
  * Abstract base class for defining actions within the FSM framework.
  *
@@ -18,8 +22,20 @@
  */
 class Action {
     Action* next{nullptr}; ///< Pointer to the next action in the chain.
+    ExecutionStats* stats{nullptr}; ///< Optional execution-time statistics.
+    uint8_t priority{0}; ///< Priority used by the scheduler; higher runs first and is skipped last.
+    unsigned long deadlineMisses{0}; ///< Executions that completed after their deadline.
 
 public:
+    /**
+     * Time reported by `getTimeUntilDue` while the action waits on something other
+     * than time, such as an event or a condition.
+     *
+     * States execute such an action on every step but derive no deadline from it;
+     * schedulers treat it as not due.
+     */
+    static constexpr unsigned long NOT_DUE = ~0UL;
+
     /**
      * Default constructor.
      */
@@ -44,6 +60,54 @@ public:
      */
     Action* getNext() const { return next; }
 
+    /**
+     * Attaches execution-time statistics, filled by the scheduler on each execution.
+     *
+     * @param executionStats The statistics, or `nullptr` to stop measuring.
+     * @return A pointer to this action for method chaining.
+     */
+    Action* setStats(ExecutionStats* executionStats) {
+        stats = executionStats;
+        return this;
+    }
+
+    /**
+     * Retrieves the execution-time statistics.
+     *
+     * @return Pointer to the statistics, or `nullptr` if the action is not measured.
+     */
+    ExecutionStats* getStats() const { return stats; }
+
+    /**
+     * Sets the priority of the action.
+     *
+     * @param level Priority; 0 is the lowest.
+     * @return A pointer to this action for method chaining.
+     */
+    Action* setPriority(const uint8_t level) {
+        priority = level;
+        return this;
+    }
+
+    /**
+     * Retrieves the priority of the action.
+     *
+     * @return The priority; 0 is the lowest.
+     */
+    uint8_t getPriority() const { return priority; }
+
+    /**
+     * Retrieves the number of executions that completed after their deadline.
+     *
+     * @return The deadline misses counted by the scheduler.
+     */
+    unsigned long getDeadlineMisses() const { return deadlineMisses; }
+
+    /**
+     * Counts a deadline miss. Called by the scheduler.
+     */
+    void countDeadlineMiss() { deadlineMisses++; }
+
     /**
      * Executes the action.
      *
@@ -58,6 +122,64 @@ public:
      * This method must be implemented by derived classes.
      */
     virtual void action() = 0;
+
+    /**
+     * Prepares the action to run from now on.
+     *
+     * Called when the state owning the action is entered (see `State::addAction`).
+     * The default implementation does nothing.
+     */
+    virtual void arm() { }
+
+    /**
+     * Prevents the action from running until it is armed again.
+     *
+     * Called when the state owning the action is exited. The default implementation
+     * does nothing.
+     */
+    virtual void disarm() { }
+
+    /**
+     * Retrieves the time until the action next needs `execute`.
+     *
+     * Used to skip executions that cannot do anything yet. The default implementation
+     * reports the action as always due.
+     *
+     * @param time Receives the time in milliseconds; 0 means due now, `NOT_DUE` that
+     *             it does not wait on time.
+     * @return `true` if the action will run again, `false` if it is finished or disarmed.
+     */
+    virtual bool getTimeUntilDue(unsigned long& time) const {
+        time = 0;
+        return true;
+    }
+
+    /**
+     * Checks whether the action will not run again.
+     *
+     * Schedulers drop finished actions. The default implementation never finishes.
+     *
+     * @return `true` if no execution is left, `false` otherwise.
+     */
+    virtual bool isFinished() const { return false; }
+
+    /**
+     * Retrieves the period of the action, used by rate-monotonic scheduling and the
+     * schedulability check.
+     *
+     * @return The period in microseconds, saturated at the largest `unsigned long`,
+     *         or 0 for an aperiodic action.
+     */
+    virtual unsigned long getPeriod() const { return 0; }
+
+    /**
+     * Retrieves the deadline of the pending execution, used by earliest-deadline-first
+     * scheduling and to count deadline misses.
+     *
+     * @param deadline Receives the deadline in `Clock` time.
+     * @return `true` if the action has a deadline, `false` otherwise.
+     */
+    virtual bool getDeadline(unsigned long&) const { return false; }
 };
 
 
@@ -18,12 +18,14 @@
 * - Support for both one-shot and periodic timing
 * - Zero-drift periodic operation
 * - Dynamic period modification
+* - Millisecond or microsecond resolution, with wrap-safe comparisons
 *
 * Methods:
 * @method start()     Starts or restarts the timer
 * @method stop()      Stops the timer
 * @method reset()     Resets the timer maintaining period reference
 * @method elapsed()   Checks if period has elapsed, updates next trigger
+* @method getMissed() Returns the periods skipped by the last trigger
 * @method setDuration(duration) Changes the period duration
 * @method isRunning() Returns timer running status
 * @method getDuration() Returns current period duration
@@ -49,24 +51,36 @@
 *    // ... later ...
 *    timer.setDuration(2000);  // Changes to 2s period
 *
+* 4. High rate:
+*    AlarmTimer timer(200, TimeUnit::MICROSECONDS); // 5 kHz
+*
 * @note This implementation maintains periodic accuracy even if the elapsed()
 * check is delayed, making it ideal for pseudo-real-time operations.
 * Period changes via setDuration() take effect after the next elapsed trigger.
+* Time is read from `Clock`, so timers follow the virtual clock during replays.
+* Durations are expressed in the unit of the timer; times are compared by their
+* difference, so `millis()` and `micros()` wrap-around is handled.
 */
 #include <Arduino.h>
+#include "Clock.h"
 
 class AlarmTimer {
-    unsigned long duration; ///< Duration of the timer in milliseconds.
+    unsigned long duration; ///< Duration of the timer, in `unit`.
+    TimeUnit unit; ///< Resolution of the timer.
     bool running{false}; ///< Indicates if the timer is running.
-    unsigned long nextTrigger{0}; ///< Time of the next trigger in milliseconds.
+    unsigned long nextTrigger{0}; ///< Time of the next trigger, in `unit`.
+    unsigned long missed{0}; ///< Periods skipped by the last trigger.
+    unsigned long lateness{0}; ///< Delay of the last trigger, in `unit`.
 
 public:
     /**
      * Constructs an alarm timer with an optional duration.
      *
-     * @param duration Duration in milliseconds. Defaults to 0.
+     * @param duration Duration in `timeUnit`. Defaults to 0.
+     * @param timeUnit Resolution of the timer. Defaults to milliseconds.
      */
-    explicit AlarmTimer(const unsigned long duration = 0) : duration(duration) { }
+    explicit AlarmTimer(const unsigned long duration = 0, const TimeUnit timeUnit = TimeUnit::MILLISECONDS)
+        : duration(duration), unit{timeUnit} { }
 
     ~AlarmTimer() = default;
 
@@ -74,10 +88,19 @@ public:
      * Starts the timer.
      */
     void start() {
-        nextTrigger = millis() + duration;
+        nextTrigger = Clock::now(unit) + duration;
         running = true;
     }
 
+    /**
+     * Checks whether the timer would trigger now, without consuming the trigger.
+     *
+     * @return `true` if running and the trigger time has passed, `false` otherwise.
+     */
+    bool isDue() const {
+        return running && static_cast<long>(Clock::now(unit) - nextTrigger) >= 0;
+    }
+
     /**
      * Checks if the timer has elapsed.
      *
@@ -86,17 +109,41 @@ public:
     bool elapsed() {
         if (!running) return false;
 
-        const unsigned long current = millis();
-        if (current >= nextTrigger) {
-            // Calculates next trigger maintaining periodicity
-            while (nextTrigger <= current) {
-                nextTrigger += duration;
-            }
+        const unsigned long current = Clock::now(unit);
+        if (static_cast<long>(current - nextTrigger) >= 0) {
+            // Calculates next trigger maintaining periodicity, skipping the periods missed
+            lateness = current - nextTrigger;
+            missed = duration > 0 ? lateness / duration : 0;
+            nextTrigger += (missed + 1) * duration;
             return true;
         }
         return false;
     }
 
+    /**
+     * Starts the timer with the first trigger after a custom delay.
+     *
+     * Later triggers keep the configured duration. Used to resume a timer
+     * saved with `remaining()`.
+     *
+     * @param remainingTime Time until the first trigger, in the unit of the timer.
+     */
+    void resume(const unsigned long remainingTime) {
+        nextTrigger = Clock::now(unit) + remainingTime;
+        running = true;
+    }
+
+    /**
+     * Retrieves the time left until the next trigger.
+     *
+     * @return The remaining time in the unit of the timer, or 0 if the timer is stopped or already elapsed.
+     */
+    unsigned long remaining() const {
+        if (!running) return 0;
+        const long left = static_cast<long>(nextTrigger - Clock::now(unit));
+        return left <= 0 ? 0 : static_cast<unsigned long>(left);
+    }
+
     /**
      * Resets the timer to its initial state and restarts it.
      */
@@ -115,13 +162,13 @@ public:
     /**
      * Sets a new duration for the timer.
      *
-     * @param newDuration The new duration in milliseconds.
+     * @param newDuration The new duration, in the unit of the timer.
      */
     void setDuration(const unsigned long newDuration) {
         duration = newDuration;
         if (running) {
             // Recalculate next trigger with new duration
-            const unsigned long current = millis();
+            const unsigned long current = Clock::now(unit);
             nextTrigger = current + duration;
         }
     }
@@ -135,14 +182,60 @@ public:
         return running;
     }
 
+    /**
+     * Retrieves the time of the next trigger.
+     *
+     * @return The `Clock` time of the next trigger, in the unit of the timer; meaningful only while running.
+     */
+    unsigned long getNextTrigger() const {
+        return nextTrigger;
+    }
+
+    /**
+     * Retrieves the number of periods skipped by the last trigger.
+     *
+     * @return Whole periods that elapsed, on top of the one reported, before `elapsed` was called.
+     */
+    unsigned long getMissed() const {
+        return missed;
+    }
+
+    /**
+     * Retrieves how late the last trigger was observed.
+     *
+     * @return Time between the trigger and the `elapsed` call that reported it, in the unit of the timer.
+     */
+    unsigned long getLateness() const {
+        return lateness;
+    }
+
     /**
      * Retrieves the current duration of the timer.
      *
-     * @return The duration in milliseconds.
+     * @return The duration, in the unit of the timer.
      */
     unsigned long getDuration() const {
         return duration;
     }
+
+    /**
+     * Sets the resolution of the timer. The duration keeps its value in the new unit.
+     *
+     * @param timeUnit The new resolution; takes effect on the next start.
+     */
+    void setUnit(const TimeUnit timeUnit) {
+        unit = timeUnit;
+        running = false;
+    }
+
+    /**
+     * Retrieves the resolution of the timer.
+     *
+     * @return The unit of durations and times of this timer.
+     */
+    TimeUnit getUnit() const {
+        return unit;
+    }
 };
 
 #endif //ALARM_TIMER_H
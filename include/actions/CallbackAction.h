@@ -0,0 +1,80 @@
+/**
+ * Actions whose work is a lambda instead of an overridden `action()`.
+ *
+ * Responsibilities:
+ * - `CallbackAction` runs its callable on every execution.
+ * - `PeriodicCallbackAction` runs it with the timing of `PeriodicAction`.
+ *
+ * Design Considerations:
+ * - The callable and its captures live inside the action object (see `Callable`),
+ *   so no subclass and no extra allocation are needed.
+ */
+
+#ifndef CALLBACK_ACTION_H
+#define CALLBACK_ACTION_H
+
+#include "Action.h"
+#include "PeriodicAction.h"
+#include "fsm/Callable.h"
+
+typedef Callable<void()> ActionCallback; ///< Work done by a callback action.
+
+/**
+ * @brief Action running a callable on every execution
+ */
+class CallbackAction final : public Action {
+    ActionCallback callback; ///< The work to do.
+
+public:
+    /**
+     * Constructs a callback action.
+     *
+     * @param work Callable run by `action`.
+     */
+    explicit CallbackAction(const ActionCallback& work) : callback{work} { }
+
+    void action() override {
+        if (callback) callback();
+    }
+};
+
+/**
+ * @brief Periodic action running a callable
+ *
+ * Usage:
+ * @code
+ * const uint8_t pin = LED_BUILTIN;
+ * scheduler->addAction(new PeriodicCallbackAction(500, [pin] { digitalWrite(pin, !digitalRead(pin)); }));
+ * @endcode
+ */
+class PeriodicCallbackAction final : public PeriodicAction {
+    ActionCallback callback; ///< The work to do.
+
+public:
+    /**
+     * Constructs a periodic callback action.
+     *
+     * @param period Time between executions in milliseconds.
+     * @param work Callable run on each execution.
+     */
+    PeriodicCallbackAction(const unsigned long period, const ActionCallback& work)
+        : PeriodicAction(period), callback{work} { }
+
+    /**
+     * Constructs a periodic callback action with an initial delay and an execution count.
+     *
+     * @param period Time between executions in milliseconds.
+     * @param delay Delay before the first execution in milliseconds.
+     * @param numberOfExecutions Number of executions, or -1 for no limit.
+     * @param work Callable run on each execution.
+     */
+    PeriodicCallbackAction(const unsigned long period, const unsigned long delay, const int numberOfExecutions,
+                           const ActionCallback& work)
+        : PeriodicAction(period, delay, numberOfExecutions), callback{work} { }
+
+    void action() override {
+        if (callback) callback();
+    }
+};
+
+#endif //CALLBACK_ACTION_H
@@ -0,0 +1,136 @@
+/**
+ * Time base shared by every timer of the library.
+ *
+ * Responsibilities:
+ * - Supplies the current time in milliseconds to `AlarmTimer` and, through it,
+ *   to states, actions and event sources, and in microseconds to timers that
+ *   need a finer resolution.
+ * - Switches to a virtual time that only moves when told to, for replays and simulations.
+ *
+ * Design Considerations:
+ * - The real time bases are `millis()` and `micros()`; the virtual mode costs one
+ *   flag test per reading.
+ * - Both readings wrap around (`micros()` after about 71 minutes); timers compare
+ *   times by their difference, so the wrap is harmless.
+ * - The clock is global, like `millis()`, so every timer of the program sees the same time.
+ */
+
+#ifndef CLOCK_H
+#define CLOCK_H
+
+#include <Arduino.h>
+
+/**
+ * Resolution of a timer.
+ */
+enum class TimeUnit : uint8_t {
+    MILLISECONDS, ///< Driven by `millis()`.
+    MICROSECONDS  ///< Driven by `micros()`.
+};
+
+/**
+ * @brief Global millisecond clock, real or virtual
+ *
+ * Usage:
+ * @code
+ * Clock::useVirtual();  // time stands still at 0
+ * fsm->start();
+ * Clock::advance(1000); // one second later, instantly
+ * fsm->run();
+ * Clock::useReal();     // back to millis()
+ * @endcode
+ */
+class Clock {
+    static unsigned long& virtualTime() {
+        static unsigned long time{0};
+        return time;
+    }
+
+    static unsigned long& virtualMicros() {
+        static unsigned long time{0};
+        return time;
+    }
+
+    static bool& virtualMode() {
+        static bool enabled{false};
+        return enabled;
+    }
+
+public:
+    /**
+     * Retrieves the current time.
+     *
+     * @return `millis()`, or the virtual time while the virtual mode is active.
+     */
+    static unsigned long now() {
+        return virtualMode() ? virtualTime() : millis();
+    }
+
+    /**
+     * Retrieves the current time in microseconds.
+     *
+     * @return `micros()`, or the virtual time in microseconds while the virtual mode is active.
+     */
+    static unsigned long nowMicros() {
+        return virtualMode() ? virtualTime() * 1000UL + virtualMicros() : micros();
+    }
+
+    /**
+     * Retrieves the current time in a given unit.
+     *
+     * @param unit Resolution of the reading.
+     * @return `now()` or `nowMicros()`.
+     */
+    static unsigned long now(const TimeUnit unit) {
+        return unit == TimeUnit::MICROSECONDS ? nowMicros() : now();
+    }
+
+    /**
+     * Switches to virtual time.
+     *
+     * @param start Initial virtual time in milliseconds.
+     */
+    static void useVirtual(const unsigned long start = 0) {
+        virtualTime() = start;
+        virtualMicros() = 0;
+        virtualMode() = true;
+    }
+
+    /**
+     * Switches back to `millis()`.
+     */
+    static void useReal() {
+        virtualMode() = false;
+    }
+
+    /**
+     * Checks whether the virtual mode is active.
+     *
+     * @return `true` if time only moves through `advance`, `false` otherwise.
+     */
+    static bool isVirtual() {
+        return virtualMode();
+    }
+
+    /**
+     * Moves the virtual time forward. Has no effect on real time.
+     *
+     * @param duration Time to add in milliseconds.
+     */
+    static void advance(const unsigned long duration) {
+        virtualTime() += duration;
+    }
+
+    /**
+     * Moves the virtual time forward by a number of microseconds. Has no effect on real time.
+     *
+     * @param duration Time to add in microseconds.
+     */
+    static void advanceMicros(const unsigned long duration) {
+        const unsigned long total = virtualMicros() + duration;
+        virtualTime() += total / 1000UL;
+        virtualMicros() = total % 1000UL;
+    }
+};
+
+#endif //CLOCK_H
@@ -0,0 +1,256 @@
+/**
+ * Static cyclic executive for periodic actions.
+ *
+ * Responsibilities:
+ * - Computes the minor frame (greatest common divisor of the periods and phases)
+ *   and the hyperperiod (least common multiple of the periods) of a set of
+ *   `PeriodicAction`s.
+ * - Builds a table listing, for each minor frame of the hyperperiod, the actions
+ *   released in it.
+ * - Walks the table on a single timer ticking once per minor frame.
+ *
+ * Design Considerations:
+ * - All scheduling decisions are taken by `build`, at startup; dispatching a frame
+ *   is a walk over a contiguous slice of the table, with no timer checks per action.
+ * - The table is a flat array of action indices plus one start offset per frame,
+ *   allocated once by `build`.
+ * - The executive calls `Action::action` directly: the actions' own timers and
+ *   execution counts are not used, and an initial delay is taken modulo the period,
+ *   as the phase of the action within the cycle.
+ * - Frames whose tick is missed because a frame overran are skipped, so the
+ *   following frames stay aligned with time; skipped frames are counted.
+ */
+
+#ifndef CYCLIC_EXECUTIVE_H
+#define CYCLIC_EXECUTIVE_H
+
+#include "PeriodicAction.h"
+#include "AlarmTimer.h"
+
+/**
+ * @brief Cyclic executive built from the periods of its actions
+ *
+ * Usage:
+ * @code
+ * CyclicExecutive executive(3, 32);
+ * executive.addAction(sampleSensor);  // period 10 ms
+ * executive.addAction(updateControl); // period 20 ms
+ * executive.addAction(refreshDisplay); // period 100 ms, delay 5 ms
+ * if (executive.build()) {            // minor frame 5 ms, hyperperiod 100 ms
+ *     executive.start();
+ * }
+ *
+ * void loop() {
+ *     executive.run();
+ * }
+ * @endcode
+ */
+class CyclicExecutive {
+    PeriodicAction** actions;      ///< Registered actions.
+    uint8_t maxActions;            ///< Capacity of `actions`.
+    uint8_t totalActions{0};       ///< Number of registered actions.
+    uint16_t maxFrames;            ///< Largest number of minor frames accepted by `build`.
+    uint8_t* slots{nullptr};       ///< Indices of the actions released, frame after frame.
+    uint16_t* frames{nullptr};     ///< Start of each frame in `slots`, plus one end offset.
+    uint16_t totalFrames{0};       ///< Minor frames in the hyperperiod.
+    unsigned long minorFrame{0};   ///< Length of a minor frame, in the unit of `timer`.
+    unsigned long hyperperiod{0};  ///< Length of the cycle, in the unit of `timer`.
+    uint16_t frame{0};             ///< Next frame to dispatch.
+    AlarmTimer timer;              ///< Ticks once per minor frame.
+    unsigned long skippedFrames{0}; ///< Frames not dispatched because their tick was missed.
+
+    static unsigned long gcd(unsigned long a, unsigned long b) {
+        while (b != 0) {
+            const unsigned long remainder = a % b;
+            a = b;
+            b = remainder;
+        }
+        return a;
+    }
+
+    /**
+     * Retrieves the phase of an action within its period.
+     *
+     * @param index Index of the action.
+     * @return The initial delay modulo the period, in microseconds.
+     */
+    unsigned long phaseOf(const uint8_t index) const {
+        const PeriodicAction* action = actions[index];
+        const unsigned long delay = action->getTimeUnit() == TimeUnit::MICROSECONDS ? action->getDelay()
+                                                                                     : action->getDelay() * 1000UL;
+        return delay % action->getPeriod();
+    }
+
+public:
+    /**
+     * Constructs a cyclic executive.
+     *
+     * @param actionCapacity Maximum number of actions.
+     * @param frameCapacity Largest number of minor frames in the hyperperiod.
+     */
+    explicit CyclicExecutive(const uint8_t actionCapacity, const uint16_t frameCapacity = 64)
+        : actions{new PeriodicAction*[actionCapacity]}, maxActions{actionCapacity}, maxFrames{frameCapacity} { }
+
+    ~CyclicExecutive() {
+        delete[] actions;
+        delete[] slots;
+        delete[] frames;
+    }
+
+    /**
+     * Registers an action. Takes effect on the next `build`.
+     *
+     * @param action The action; its period must not be 0, and its period and delay
+     *        must fit in an `unsigned long` of microseconds.
+     * @return `true` if registered, `false` if the executive is full or the period
+     *         or the delay does not fit.
+     */
+    bool addAction(PeriodicAction* action) {
+        const unsigned long period = action->getPeriod();
+        if (totalActions >= maxActions || period == 0 || period == static_cast<unsigned long>(-1)) return false;
+        if (action->getTimeUnit() == TimeUnit::MILLISECONDS
+            && action->getDelay() > static_cast<unsigned long>(-1) / 1000UL) return false;
+        actions[totalActions++] = action;
+        return true;
+    }
+
+    /**
+     * Computes the minor frame and the hyperperiod, and builds the schedule table.
+     *
+     * The table is computed in microseconds; the tick timer runs in milliseconds
+     * when the minor frame is a whole number of them, in microseconds otherwise.
+     *
+     * @return `true` if the table was built, `false` if there are no actions, the
+     *         hyperperiod overflows or the table would be larger than `frameCapacity`
+     *         minor frames or 65535 releases.
+     */
+    bool build() {
+        if (totalActions == 0) return false;
+
+        unsigned long minor = 0;
+        unsigned long cycle = 1;
+        for (uint8_t i = 0; i < totalActions; i++) {
+            const unsigned long period = actions[i]->getPeriod();
+            minor = gcd(gcd(minor, period), phaseOf(i));
+            const unsigned long factor = period / gcd(cycle, period);
+            if (cycle > static_cast<unsigned long>(-1) / factor) return false;
+            cycle *= factor;
+        }
+        if (cycle / minor > maxFrames) return false;
+
+        unsigned long totalSlots = 0;
+        for (uint8_t i = 0; i < totalActions; i++) {
+            totalSlots += cycle / actions[i]->getPeriod();
+        }
+        if (totalSlots > 0xFFFF) return false;
+
+        delete[] slots;
+        delete[] frames;
+        totalFrames = cycle / minor;
+        slots = new uint8_t[totalSlots];
+        frames = new uint16_t[totalFrames + 1];
+
+        uint16_t slot = 0;
+        for (uint16_t f = 0; f < totalFrames; f++) {
+            frames[f] = slot;
+            const unsigned long time = f * minor;
+            for (uint8_t i = 0; i < totalActions; i++) {
+                const unsigned long period = actions[i]->getPeriod();
+                if (time % period == phaseOf(i)) {
+                    slots[slot++] = i;
+                }
+            }
+        }
+        frames[totalFrames] = slot;
+
+        const TimeUnit unit = minor % 1000UL == 0 ? TimeUnit::MILLISECONDS : TimeUnit::MICROSECONDS;
+        const unsigned long scale = unit == TimeUnit::MILLISECONDS ? 1000UL : 1UL;
+        minorFrame = minor / scale;
+        hyperperiod = cycle / scale;
+        timer.setUnit(unit);
+        timer.setDuration(minorFrame);
+        return true;
+    }
+
+    /**
+     * Starts the cycle; the first frame is dispatched by the next `run`.
+     */
+    void start() {
+        frame = 0;
+        timer.resume(0);
+    }
+
+    /**
+     * Stops the cycle.
+     */
+    void stop() {
+        timer.stop();
+    }
+
+    /**
+     * Dispatches the current minor frame once its tick has come.
+     *
+     * @return `true` if a frame was dispatched, `false` otherwise.
+     */
+    bool run() {
+        if (totalFrames == 0) return false;
+        const unsigned long tick = timer.getNextTrigger();
+        if (!timer.elapsed()) return false;
+
+        // Frames whose tick already passed are dropped to stay aligned with time
+        const unsigned long missed = (Clock::now(timer.getUnit()) - tick) / minorFrame;
+        if (missed > 0) {
+            skippedFrames += missed;
+            frame = (frame + missed) % totalFrames;
+        }
+
+        for (uint16_t slot = frames[frame]; slot < frames[frame + 1]; slot++) {
+            actions[slots[slot]]->action();
+        }
+        if (++frame == totalFrames) {
+            frame = 0;
+        }
+        return true;
+    }
+
+    /**
+     * Retrieves the length of a minor frame.
+     *
+     * @return The minor frame, in `getTimeUnit`, or 0 before `build`.
+     */
+    unsigned long getMinorFrame() const { return minorFrame; }
+
+    /**
+     * Retrieves the length of the cycle.
+     *
+     * @return The hyperperiod, in `getTimeUnit`, or 0 before `build`.
+     */
+    unsigned long getHyperperiod() const { return hyperperiod; }
+
+    /**
+     * Retrieves the resolution of the tick timer chosen by `build`.
+     *
+     * @return The unit of `getMinorFrame` and `getHyperperiod`.
+     */
+    TimeUnit getTimeUnit() const { return timer.getUnit(); }
+
+    /**
+     * Retrieves the number of minor frames in the cycle.
+     *
+     * @return The number of frames of the table.
+     */
+    uint16_t getFrameCount() const { return totalFrames; }
+
+    /**
+     * Retrieves the number of frames dropped because their tick was missed.
+     *
+     * @return The skipped frames; non-zero means some frame overran.
+     */
+    unsigned long getSkippedFrames() const { return skippedFrames; }
+
+    // Disallow copy and assignment.
+    CyclicExecutive(const CyclicExecutive&) = delete;
+    CyclicExecutive& operator=(const CyclicExecutive&) = delete;
+};
+
+#endif //CYCLIC_EXECUTIVE_H
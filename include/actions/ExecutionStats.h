@@ -0,0 +1,242 @@
+/**
+ * Execution-time statistics and budgets for actions and state hooks.
+ *
+ * Responsibilities:
+ * - Records how long each execution took, keeping the minimum, the maximum and a
+ *   histogram from which percentiles of the execution time are read.
+ * - Compares each execution with an optional budget and counts the overruns.
+ * - Carries the policy the caller applies on an overrun.
+ *
+ * Design Considerations:
+ * - Durations are measured in microseconds with `micros()`, independently of `Clock`.
+ * - The histogram has one bucket per power of two, so percentiles are upper bounds
+ *   within a factor of two; the maximum is exact. Counts are 16-bit and halve when
+ *   one would overflow, which keeps the distribution and ages old samples.
+ * - Statistics are opt-in: nothing is measured for an action or state without them.
+ */
+
+#ifndef EXECUTION_STATS_H
+#define EXECUTION_STATS_H
+
+#include <Arduino.h>
+
+/**
+ * What to do when an execution exceeds its budget.
+ */
+enum class OverrunPolicy : uint8_t {
+    COUNT,            ///< Only count the overrun.
+    LOG,              ///< Count it and print a line to `Serial`.
+    SKIP_LOW_PRIORITY,///< Count it and skip lower-priority actions for the rest of the cycle.
+    DEMOTE            ///< Count it and lower the action to the lowest priority.
+};
+
+/**
+ * @brief Execution-time statistics with a budget
+ *
+ * Usage:
+ * @code
+ * auto stats = new ExecutionStats(500, OverrunPolicy::LOG); // 500 us budget
+ * scheduler->addAction(logger->setStats(stats));
+ * ...
+ * stats->print(Serial); // count, min, p50, p99, max, overruns
+ * @endcode
+ */
+class ExecutionStats {
+public:
+    static constexpr uint8_t BUCKETS = 16; ///< Histogram buckets: 0 us, then [2^(i-1), 2^i) us.
+
+private:
+    unsigned long count{0};       ///< Executions recorded.
+    unsigned long minimum{0};     ///< Shortest execution in microseconds.
+    unsigned long maximum{0};     ///< Longest execution in microseconds.
+    unsigned long budget;         ///< Budget in microseconds, 0 for none.
+    unsigned long overruns{0};    ///< Executions longer than the budget.
+    uint16_t histogram[BUCKETS]{};///< Executions per duration bucket.
+    OverrunPolicy policy;         ///< Policy applied on an overrun.
+
+    /**
+     * Finds the histogram bucket of a duration.
+     *
+     * @param duration Duration in microseconds.
+     * @return The bucket index.
+     */
+    static uint8_t bucketOf(unsigned long duration) {
+        uint8_t bucket = 0;
+        while (duration > 0 && bucket < BUCKETS - 1) {
+            duration >>= 1;
+            bucket++;
+        }
+        return bucket;
+    }
+
+public:
+    /**
+     * Constructs statistics with an optional budget.
+     *
+     * @param budgetMicros Budget in microseconds, 0 for none.
+     * @param overrunPolicy Policy applied when the budget is exceeded.
+     */
+    explicit ExecutionStats(const unsigned long budgetMicros = 0, const OverrunPolicy overrunPolicy = OverrunPolicy::COUNT)
+        : budget{budgetMicros}, policy{overrunPolicy} { }
+
+    /**
+     * Records one execution.
+     *
+     * @param duration Execution time in microseconds.
+     * @return `true` if the execution exceeded the budget, `false` otherwise.
+     */
+    bool record(const unsigned long duration) {
+        if (count == 0 || duration < minimum) minimum = duration;
+        if (duration > maximum) maximum = duration;
+        count++;
+
+        uint16_t& bucket = histogram[bucketOf(duration)];
+        if (bucket == 0xFFFF) {
+            for (uint16_t& entry : histogram) {
+                entry >>= 1;
+            }
+        }
+        bucket++;
+
+        if (budget == 0 || duration <= budget) return false;
+        overruns++;
+        if (policy == OverrunPolicy::LOG) {
+            Serial.print(F("Overrun: "));
+            Serial.print(duration);
+            Serial.print(F(" us, budget "));
+            Serial.print(budget);
+            Serial.println(F(" us"));
+        }
+        return true;
+    }
+
+    /**
+     * Retrieves a percentile of the execution time.
+     *
+     * @param percent The percentile, from 1 to 100.
+     * @return An upper bound of the percentile in microseconds, never above the maximum.
+     */
+    unsigned long getPercentile(const uint8_t percent) const {
+        unsigned long total = 0;
+        for (const uint16_t entry : histogram) {
+            total += entry;
+        }
+        if (total == 0) return 0;
+
+        const unsigned long rank = (total * percent + 99) / 100;
+        unsigned long seen = 0;
+        for (uint8_t bucket = 0; bucket < BUCKETS; bucket++) {
+            seen += histogram[bucket];
+            if (seen >= rank) {
+                const unsigned long bound = bucket == 0 ? 0 : (1UL << bucket) - 1;
+                return bucket == BUCKETS - 1 || bound > maximum ? maximum : bound;
+            }
+        }
+        return maximum;
+    }
+
+    /**
+     * Clears the recorded executions and overruns, keeping the budget and policy.
+     */
+    void reset() {
+        count = minimum = maximum = overruns = 0;
+        for (uint16_t& entry : histogram) {
+            entry = 0;
+        }
+    }
+
+    /**
+     * Prints a one-line summary: count, min, p50, p99, max and overruns.
+     *
+     * @param out Destination, such as `Serial`.
+     */
+    void print(Print& out) const {
+        out.print(F("n="));
+        out.print(count);
+        out.print(F(" min="));
+        out.print(minimum);
+        out.print(F(" p50<="));
+        out.print(getPercentile(50));
+        out.print(F(" p99<="));
+        out.print(getPercentile(99));
+        out.print(F(" max="));
+        out.print(maximum);
+        out.print(F(" us overruns="));
+        out.println(overruns);
+    }
+
+    /**
+     * Retrieves the number of executions recorded.
+     *
+     * @return The executions since construction or the last `reset`.
+     */
+    unsigned long getCount() const { return count; }
+
+    /**
+     * Retrieves the shortest execution.
+     *
+     * @return The duration in microseconds, or 0 if none was recorded.
+     */
+    unsigned long getMin() const { return minimum; }
+
+    /**
+     * Retrieves the longest execution.
+     *
+     * @return The duration in microseconds, or 0 if none was recorded.
+     */
+    unsigned long getMax() const { return maximum; }
+
+    /**
+     * Retrieves the number of executions longer than the budget.
+     *
+     * @return The overruns since construction or the last `reset`.
+     */
+    unsigned long getOverruns() const { return overruns; }
+
+    /**
+     * Retrieves the budget.
+     *
+     * @return The budget in microseconds, or 0 for none.
+     */
+    unsigned long getBudget() const { return budget; }
+
+    /**
+     * Retrieves the policy applied on an overrun.
+     *
+     * @return The policy set at construction or by `setBudget`.
+     */
+    OverrunPolicy getPolicy() const { return policy; }
+
+    /**
+     * Sets the budget and the policy applied when it is exceeded.
+     *
+     * @param budgetMicros Budget in microseconds, 0 for none.
+     * @param overrunPolicy Policy applied on an overrun.
+     * @return A pointer to these statistics for method chaining.
+     */
+    ExecutionStats* setBudget(const unsigned long budgetMicros, const OverrunPolicy overrunPolicy = OverrunPolicy::COUNT) {
+        budget = budgetMicros;
+        policy = overrunPolicy;
+        return this;
+    }
+};
+
+/**
+ * Statistics of the three hooks of a state, filled by the FSM (see `State::setProfile`).
+ */
+struct StateProfile {
+    ExecutionStats enter;  ///< `onEnter` executions.
+    ExecutionStats update; ///< `onUpdate` executions.
+    ExecutionStats exit;   ///< `onExit` executions.
+
+    /**
+     * Constructs a profile with the same budget for the three hooks.
+     *
+     * @param budgetMicros Budget in microseconds, 0 for none.
+     * @param overrunPolicy `COUNT` or `LOG`; the other policies only apply to actions.
+     */
+    explicit StateProfile(const unsigned long budgetMicros = 0, const OverrunPolicy overrunPolicy = OverrunPolicy::COUNT)
+        : enter{budgetMicros, overrunPolicy}, update{budgetMicros, overrunPolicy}, exit{budgetMicros, overrunPolicy} { }
+};
+
+#endif //EXECUTION_STATS_H
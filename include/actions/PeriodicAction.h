@@ -7,6 +7,16 @@
 
 #include "Action.h"
 #include "AlarmTimer.h"
+#include "fsm/SnapshotCodec.h"
+
+/**
+ * What a `PeriodicAction` does about the periods missed while the loop was stalled.
+ */
+enum class MissedTickPolicy : uint8_t {
+    SKIP,     ///< Run once; the missed periods are lost.
+    BURST,    ///< Run once per missed period, up to a limit, then once more.
+    COALESCE  ///< Run once through `coalesce`, which receives the missed periods.
+};
 
 /**
 * @brief Base class for periodic actions with precise timing
@@ -20,6 +30,8 @@
 * - Optional delay for first execution
 * - Configurable number of executions
 * - Automatic completion tracking
+* - Missed-period accounting and catch-up policy
+* - Millisecond or microsecond periods (see `setTimeUnit`)
 *
 * Usage:
 * @code
@@ -42,15 +54,39 @@
 */
 
 class PeriodicAction : public Action {
-    unsigned long period; ///< Time period between executions in milliseconds.
-    unsigned long delay{0}; ///< Initial delay before the first execution in milliseconds.
+    unsigned long period; ///< Time period between executions, in the unit of `timer`.
+    unsigned long delay{0}; ///< Initial delay before the first execution, in the unit of `timer`.
     AlarmTimer* timer; ///< Timer to manage periodic execution.
     int executionsLeft{-1}; ///< Number of remaining executions. `-1` indicates infinite.
+    int executions{-1}; ///< Number of executions configured, restored by `arm`.
     bool firstExecution{true}; ///< Indicates whether the action is being executed for the first time.
     bool delayed{false}; ///< Indicates whether the initial delay has been applied.
+    MissedTickPolicy missedTickPolicy{MissedTickPolicy::SKIP}; ///< Handling of missed periods.
+    uint8_t burstLimit{4}; ///< Most missed periods caught up by one `BURST`.
+    unsigned long lastMissed{0}; ///< Periods not executed before the current execution.
+    unsigned long missedTicks{0}; ///< Total periods not executed.
+    unsigned long lateness{0}; ///< Lateness of the current execution, in the unit of `timer`.
+    unsigned long maxLateness{0}; ///< Largest lateness observed, in the unit of `timer`.
+
+    /**
+     * Converts a duration of this action to milliseconds, rounding down.
+     */
+    unsigned long toMillis(const unsigned long duration) const {
+        return timer->getUnit() == TimeUnit::MICROSECONDS ? duration / 1000UL : duration;
+    }
+
+    // Snapshot flags.
+    static constexpr uint8_t SNAPSHOT_FIRST   = 0x01;
+    static constexpr uint8_t SNAPSHOT_DELAYED = 0x02;
+    static constexpr uint8_t SNAPSHOT_TIMER   = 0x04;
 
 
 public:
+    /**
+     * Largest encoding produced by `snapshot`: flags, executions left and remaining time.
+     */
+    static constexpr size_t SNAPSHOT_MAX_SIZE = 1 + (sizeof(int) * 8 + 6) / 7 + (sizeof(unsigned long) * 8 + 6) / 7;
+
     /**
      * Constructs a periodic action with a specified period.
      *
@@ -81,7 +117,7 @@ public:
      * @param numberOfExecutions Total number of executions before stopping.
      */
     explicit PeriodicAction(const unsigned long period, const unsigned long delay, const int numberOfExecutions):
-    period(period), delay{delay}, executionsLeft(numberOfExecutions) {
+    period(period), delay{delay}, executionsLeft(numberOfExecutions), executions(numberOfExecutions) {
         if (delay > 0) {
             timer = new AlarmTimer(delay);
         } else {
@@ -97,6 +133,20 @@ public:
      */
      void action() override = 0;
 
+    /**
+     * Executes once on behalf of the current period and the missed ones, under the
+     * `COALESCE` policy.
+     *
+     * Override to compensate for the lost periods, for instance by integrating a
+     * sensor over `missed + 1` periods. The default implementation calls `action`.
+     *
+     * @param missed Periods missed since the previous execution, 0 on time.
+     */
+    virtual void coalesce(const unsigned long missed) {
+        (void) missed;
+        action();
+    }
+
     /**
      * Executes the periodic action if its timer has elapsed.
      */
@@ -123,16 +173,234 @@ public:
         // Now others executions
         // If there was a delay, it will be met here.
         if (timer->elapsed()) {  // AlarmTimer already ensures periodicity, no need to execute start() again
-            action();
-            if (executionsLeft > 0) {
-                executionsLeft--;
+            const unsigned long missed = timer->getMissed();
+            lateness = timer->getLateness();
+            if (lateness > maxLateness) {
+                maxLateness = lateness;
+            }
+            unsigned long catchUp = 0;
+            if (missedTickPolicy == MissedTickPolicy::BURST) {
+                catchUp = missed < burstLimit ? missed : burstLimit;
+            }
+            lastMissed = missed - catchUp;
+            missedTicks += lastMissed;
+            for (unsigned long run = 0; run <= catchUp && executionsLeft != 0; run++) {
+                if (missedTickPolicy == MissedTickPolicy::COALESCE) {
+                    coalesce(lastMissed);
+                } else {
+                    action();
+                }
+                if (executionsLeft > 0) {
+                    executionsLeft--;
+                }
             }
             if (!delayed && delay > 0) {
                 delayed = true;
                 timer->setDuration(period);
             }
+        }
+    }
+
+    /**
+     * Sets the resolution of the period and delay given to the constructor.
+     *
+     * With `MICROSECONDS` the action is timed with `micros()`, for rates above 1 kHz.
+     * Call before the first execution.
+     *
+     * @param unit The resolution.
+     * @return A pointer to this action for method chaining.
+     */
+    PeriodicAction* setTimeUnit(const TimeUnit unit) {
+        timer->setUnit(unit);
+        return this;
+    }
+
+    /**
+     * Retrieves the resolution of the period and delay.
+     *
+     * @return The unit of the action's durations.
+     */
+    TimeUnit getTimeUnit() const { return timer->getUnit(); }
+
+    /**
+     * Sets what to do about the periods missed while the loop was stalled.
+     *
+     * @param policy `SKIP` (default), `BURST` or `COALESCE`.
+     * @param limit Most missed periods run by one `BURST`; the rest are lost.
+     * @return A pointer to this action for method chaining.
+     */
+    PeriodicAction* setMissedTickPolicy(const MissedTickPolicy policy, const uint8_t limit = 4) {
+        missedTickPolicy = policy;
+        burstLimit = limit;
+        return this;
+    }
+
+    /**
+     * Retrieves the periods not executed before the current execution.
+     *
+     * Meant to be read from `action` to compensate for the lost samples; under
+     * `COALESCE`, it is also passed to `coalesce`.
+     *
+     * @return The periods missed and not caught up.
+     */
+    unsigned long getLastMissed() const { return lastMissed; }
+
+    /**
+     * Retrieves the total number of periods not executed.
+     *
+     * @return The periods missed and not caught up since construction.
+     */
+    unsigned long getMissedTicks() const { return missedTicks; }
+
+    /**
+     * Retrieves the lateness of the current execution.
+     *
+     * @return Time between the due time and the execution, in the unit of the action.
+     */
+    unsigned long getLateness() const { return lateness; }
+
+    /**
+     * Retrieves the largest lateness observed.
+     *
+     * @return The worst time between a due time and its execution, in the unit of the action.
+     */
+    unsigned long getMaxLateness() const { return maxLateness; }
+
+    /**
+     * Restarts the action as if it had just been created: the first execution comes
+     * immediately or after the initial delay, and the execution count is restored.
+     */
+    void arm() override {
+        executionsLeft = executions;
+        delayed = false;
+        if (delay > 0) {
+            firstExecution = false;
+            timer->setDuration(delay);
             timer->start();
+        } else {
+            firstExecution = true;
+            timer->setDuration(period);
+            timer->stop();
+        }
+    }
+
+    /**
+     * Stops the action until `arm` is called again.
+     */
+    void disarm() override {
+        firstExecution = false;
+        timer->stop();
+    }
+
+    /**
+     * Retrieves the time until the next execution.
+     *
+     * @param time Receives the time in milliseconds; 0 means due now.
+     * @return `true` if the action will run again, `false` if it is finished or disarmed.
+     */
+    bool getTimeUntilDue(unsigned long& time) const override {
+        if (executionsLeft == 0) return false;
+        if (firstExecution) {
+            time = 0;
+            return true;
+        }
+        if (!timer->isRunning()) return false;
+        // Rounded down, so microsecond actions are polled during their last millisecond
+        time = toMillis(timer->remaining());
+        return true;
+    }
+
+    /**
+     * Retrieves the period of the action.
+     *
+     * Millisecond periods longer than an `unsigned long` of microseconds saturate,
+     * so such actions share the lowest rate-monotonic rank.
+     *
+     * @return The period in microseconds.
+     */
+    unsigned long getPeriod() const override {
+        if (timer->getUnit() == TimeUnit::MICROSECONDS) return period;
+        return period > static_cast<unsigned long>(-1) / 1000UL ? static_cast<unsigned long>(-1) : period * 1000UL;
+    }
+
+    /**
+     * Retrieves the initial delay.
+     *
+     * @return The delay before the first execution, in the unit of the action.
+     */
+    unsigned long getDelay() const { return delay; }
+
+    /**
+     * Retrieves the deadline of the pending execution: the end of the period it was
+     * released in.
+     *
+     * @param deadline Receives the deadline in `Clock` time.
+     * @return `true` if an execution is pending, `false` if the action is finished or disarmed.
+     */
+    bool getDeadline(unsigned long& deadline) const override {
+        if (executionsLeft == 0) return false;
+        if (firstExecution) {
+            deadline = Clock::now() + toMillis(period);
+            return true;
+        }
+        if (!timer->isRunning()) return false;
+        if (timer->getUnit() == TimeUnit::MICROSECONDS) {
+            deadline = Clock::now() + toMillis(timer->remaining() + period);
+        } else {
+            deadline = timer->getNextTrigger() + period;
+        }
+        return true;
+    }
+
+    /**
+     * Encodes the pending execution state of the action.
+     *
+     * The snapshot holds whether the first execution or the initial delay are still
+     * pending, the executions left, and the time left until the next execution.
+     *
+     * @param buffer Destination buffer, `SNAPSHOT_MAX_SIZE` bytes are always enough.
+     * @param size Capacity of the buffer in bytes.
+     * @return The number of bytes written, or 0 if the buffer is too small.
+     */
+    size_t snapshot(uint8_t* buffer, const size_t size) const {
+        SnapshotWriter writer(buffer, size);
+        uint8_t flags = 0;
+        if (firstExecution) flags |= SNAPSHOT_FIRST;
+        if (delayed) flags |= SNAPSHOT_DELAYED;
+        if (timer->isRunning()) flags |= SNAPSHOT_TIMER;
+        writer.writeByte(flags);
+        writer.writeSigned(executionsLeft);
+        if (timer->isRunning()) {
+            writer.writeVarint(timer->remaining());
+        }
+        return writer.getLength();
+    }
+
+    /**
+     * Resumes the action from a snapshot.
+     *
+     * @param buffer Snapshot produced by `snapshot`.
+     * @param size Length of the snapshot in bytes.
+     * @return `true` if the snapshot was valid and applied, `false` otherwise.
+     */
+    bool restore(const uint8_t* buffer, const size_t size) {
+        SnapshotReader reader(buffer, size);
+        const uint8_t flags = reader.readByte();
+        const long executions = reader.readSigned();
+        const unsigned long remaining = (flags & SNAPSHOT_TIMER) ? reader.readVarint() : 0;
+        if (!reader.isValid()) return false;
+
+        firstExecution = flags & SNAPSHOT_FIRST;
+        delayed = flags & SNAPSHOT_DELAYED;
+        executionsLeft = static_cast<int>(executions);
+        // Until the initial delay has elapsed the timer still runs with the delay
+        timer->setDuration(!delayed && delay > 0 ? delay : period);
+        if (flags & SNAPSHOT_TIMER) {
+            timer->resume(remaining);
+        } else {
+            timer->stop();
         }
+        return true;
     }
 
     /**
@@ -140,7 +408,7 @@ public:
      *
      * @return `true` if no executions are left, `false` otherwise.
      */
-    bool isFinished() const {
+    bool isFinished() const override {
         return executionsLeft == 0;
     }
 
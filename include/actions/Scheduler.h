@@ -6,10 +6,22 @@
 #define SCHEDULER_H
 
 #include "Action.h"
+#include "ExecutionStats.h"
+#include "Clock.h"
 
 #define SCHEDULER_DEBUG
 #include "ActionDebug.h"
 
+/**
+ * Order in which a `Scheduler` executes its due actions.
+ */
+enum class SchedulingPolicy : uint8_t {
+    ROUND_ROBIN,             ///< Insertion order.
+    FIXED_PRIORITY,          ///< Highest `Action::getPriority` first.
+    RATE_MONOTONIC,          ///< Fixed priorities assigned from the periods, shortest first.
+    EARLIEST_DEADLINE_FIRST  ///< Earliest `Action::getDeadline` first, re-evaluated on every run.
+};
+
 /**
 * @brief Scheduler for managing multiple periodic actions with precise timing
 *
@@ -68,18 +80,169 @@ class Scheduler {
     Action* first{nullptr}; ///< Pointer to the first action in the sequence.
     Action* last{nullptr}; ///< Pointer to the last action in the sequence.
     int currentActions{0}; ///< Number of actions in the scheduler.
+    unsigned long skipped{0}; ///< Executions skipped after an overrun.
+    SchedulingPolicy policy; ///< Order in which due actions execute.
+    float utilization{0}; ///< Declared processor utilization of the periodic actions.
+    bool schedulable{true}; ///< Result of the last schedulability check.
+
+    /**
+     * Compares two `Clock` times, tolerating wrap-around.
+     */
+    static bool isBefore(const unsigned long a, const unsigned long b) {
+        return static_cast<long>(a - b) < 0;
+    }
+
+    /**
+     * Checks whether an action must execute before another under the current policy.
+     *
+     * @param a First action.
+     * @param b Second action.
+     * @return `true` if `a` strictly precedes `b`.
+     */
+    bool precedes(const Action* a, const Action* b) const {
+        switch (policy) {
+            case SchedulingPolicy::FIXED_PRIORITY:
+            case SchedulingPolicy::RATE_MONOTONIC:
+                return a->getPriority() > b->getPriority();
+            case SchedulingPolicy::EARLIEST_DEADLINE_FIRST: {
+                unsigned long deadlineA, deadlineB;
+                if (!a->getDeadline(deadlineA)) return false;
+                if (!b->getDeadline(deadlineB)) return true;
+                return isBefore(deadlineA, deadlineB);
+            }
+            default:
+                return false;
+        }
+    }
+
+    /**
+     * Orders the actions by the current policy with a stable insertion sort.
+     * Nearly sorted lists, the usual case between runs, cost one pass.
+     */
+    void sort() {
+        if (policy == SchedulingPolicy::ROUND_ROBIN) return;
+        Action* sorted = nullptr;
+        Action* tail = nullptr;
+        for (Action* action = first; action != nullptr;) {
+            Action* next = action->getNext();
+            if (!sorted) {
+                action->setNext(nullptr);
+                sorted = tail = action;
+            } else if (!precedes(action, tail)) {
+                action->setNext(nullptr);
+                tail->setNext(action);
+                tail = action;
+            } else if (precedes(action, sorted)) {
+                action->setNext(sorted);
+                sorted = action;
+            } else {
+                Action* position = sorted;
+                while (!precedes(action, position->getNext())) {
+                    position = position->getNext();
+                }
+                action->setNext(position->getNext());
+                position->setNext(action);
+            }
+            action = next;
+        }
+        first = sorted;
+        last = tail;
+    }
+
+    /**
+     * Gives shorter periods higher priorities; aperiodic actions get priority 0.
+     */
+    void assignRateMonotonicPriorities() {
+        for (Action* action = first; action != nullptr; action = action->getNext()) {
+            const unsigned long period = action->getPeriod();
+            uint8_t rank = 0;
+            if (period > 0) {
+                rank = 1;
+                for (const Action* other = first; other != nullptr; other = other->getNext()) {
+                    if (other->getPeriod() > period && rank < 255) rank++;
+                }
+            }
+            action->setPriority(rank);
+        }
+    }
+
+    /**
+     * Sums the utilization of the periodic actions whose statistics declare a budget,
+     * and compares it with the bound of the policy: 1 for earliest-deadline-first
+     * and round-robin, the Liu-Layland bound n(2^(1/n) - 1) for fixed priorities.
+     */
+    void check() {
+        utilization = 0;
+        uint8_t count = 0;
+        for (const Action* action = first; action != nullptr; action = action->getNext()) {
+            const ExecutionStats* stats = action->getStats();
+            const unsigned long period = action->getPeriod();
+            if (period > 0 && stats && stats->getBudget() > 0) {
+                utilization += static_cast<float>(stats->getBudget()) / period;
+                count++;
+            }
+        }
+        float bound = 1.0f;
+        if (count > 0 && (policy == SchedulingPolicy::FIXED_PRIORITY || policy == SchedulingPolicy::RATE_MONOTONIC)) {
+            bound = count * (pow(2.0, 1.0 / count) - 1.0);
+        }
+        schedulable = utilization <= bound;
+    }
+
+    /**
+     * Removes an action from the list.
+     *
+     * @param previous The action before it, or `nullptr` if it is the first.
+     * @param action The action to remove.
+     */
+    void unlink(Action* previous, Action* action) {
+        if (previous) {
+            previous->setNext(action->getNext());
+        } else {
+            first = action->getNext();
+        }
+        if (last == action) {
+            last = previous;
+        }
+        action->setNext(nullptr);
+        currentActions--;
+    }
+
+    /**
+     * Removes the actions that will not run again, so they are not visited any more.
+     */
+    void removeFinished() {
+        Action* previous = nullptr;
+        for (Action* action = first; action != nullptr;) {
+            Action* next = action->getNext();
+            if (action->isFinished()) {
+                unlink(previous, action);
+            } else {
+                previous = action;
+            }
+            action = next;
+        }
+        check();
+    }
 
 public:
-    explicit Scheduler() = default;
+    /**
+     * Constructs a scheduler.
+     *
+     * @param schedulingPolicy Order in which due actions execute. Defaults to insertion order.
+     */
+    explicit Scheduler(const SchedulingPolicy schedulingPolicy = SchedulingPolicy::ROUND_ROBIN)
+        : policy{schedulingPolicy} { }
     ~Scheduler() = default;
 
     /**
-     * Adds an action to the scheduler.
+     * Adds an action to the scheduler and re-runs the schedulability check.
      *
      * @param action Pointer to the action to add.
      * @return A pointer to this scheduler for method chaining.
      */
     Scheduler* addAction(Action* action) {
+        action->setNext(nullptr);
         if (!first) {
             first = action;
             last = action;
@@ -87,18 +250,129 @@ public:
             last->setNext(action);
             last = action;
         }
+        currentActions++;
+        if (policy == SchedulingPolicy::RATE_MONOTONIC) {
+            assignRateMonotonicPriorities();
+        }
+        sort();
+        check();
         return this;
     }
 
+    /**
+     * Changes the scheduling policy.
+     *
+     * @param schedulingPolicy The new policy.
+     * @return A pointer to this scheduler for method chaining.
+     */
+    Scheduler* setPolicy(const SchedulingPolicy schedulingPolicy) {
+        policy = schedulingPolicy;
+        if (policy == SchedulingPolicy::RATE_MONOTONIC) {
+            assignRateMonotonicPriorities();
+        }
+        sort();
+        check();
+        return this;
+    }
 
     /**
-     * Executes all registered actions sequentially.
+     * Executes all due actions in the order of the scheduling policy.
+     *
+     * Behavior:
+     * - Round-robin keeps insertion order, fixed-priority and rate-monotonic run higher
+     *   priorities first, earliest-deadline-first re-sorts by deadline on each run.
+     * - Actions that are not due yet (see `Action::getTimeUntilDue`) are not executed.
+     * - Actions that finish (see `Action::isFinished`) are removed from the scheduler.
+     * - An execution that completes after its deadline counts a deadline miss.
+     * - Actions with statistics are timed; on an overrun their policy is applied:
+     *   `SKIP_LOW_PRIORITY` skips the due actions of lower priority for the rest of
+     *   this run, `DEMOTE` drops the action to priority 0.
      */
-    void run() const {
+    void run() {
+        if (policy == SchedulingPolicy::EARLIEST_DEADLINE_FIRST) {
+            sort();
+        }
+        bool skipping = false;
+        bool demoted = false;
+        bool finished = false;
+        uint8_t floor = 0;
         for (Action* action = first; action != nullptr; action = action->getNext()) {
+            unsigned long wait;
+            if (!action->getTimeUntilDue(wait) || wait > 0) continue;
+            if (skipping && action->getPriority() < floor) {
+                skipped++;
+                continue;
+            }
+
+            unsigned long deadline;
+            const bool hasDeadline = action->getDeadline(deadline);
+            ExecutionStats* stats = action->getStats();
+            const unsigned long start = stats ? micros() : 0;
             action->execute();
+            const bool overrun = stats && stats->record(micros() - start);
+            if (hasDeadline && isBefore(deadline, Clock::now())) {
+                action->countDeadlineMiss();
+            }
+            finished = finished || action->isFinished();
+            if (!overrun) continue;
+
+            if (stats->getPolicy() == OverrunPolicy::SKIP_LOW_PRIORITY) {
+                skipping = true;
+                if (action->getPriority() > floor) floor = action->getPriority();
+            } else if (stats->getPolicy() == OverrunPolicy::DEMOTE) {
+                action->setPriority(0);
+                demoted = true;
+            }
+        }
+        if (finished) {
+            removeFinished();
+        }
+        if (demoted) {
+            sort();
         }
     }
+
+    /**
+     * Removes an action from the scheduler.
+     *
+     * @param action The action to remove.
+     * @return `true` if the action was scheduled and is removed, `false` otherwise.
+     */
+    bool removeAction(const Action* action) {
+        Action* previous = nullptr;
+        for (Action* current = first; current != nullptr; current = current->getNext()) {
+            if (current == action) {
+                unlink(previous, current);
+                check();
+                return true;
+            }
+            previous = current;
+        }
+        return false;
+    }
+
+    /**
+     * Retrieves the number of executions skipped after an overrun.
+     *
+     * @return Due actions not executed because of a `SKIP_LOW_PRIORITY` overrun.
+     */
+    unsigned long getSkipped() const { return skipped; }
+
+    /**
+     * Retrieves the declared utilization of the periodic actions with a budget.
+     *
+     * @return The sum of budget / period.
+     */
+    float getUtilization() const { return utilization; }
+
+    /**
+     * Checks the result of the last schedulability test.
+     *
+     * Actions without a period or without a budget are not part of the test.
+     *
+     * @return `true` if the declared utilization is within the bound of the policy.
+     */
+    bool isSchedulable() const { return schedulable; }
 };
 
 #endif //SCHEDULER_H
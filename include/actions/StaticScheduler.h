@@ -0,0 +1,197 @@
+/**
+ * Fixed-capacity scheduler with constant-time insertion and removal.
+ *
+ * Responsibilities:
+ * - Holds up to `Capacity` actions in an array sized at compile time.
+ * - Hands out a handle per action, by which it is removed in constant time.
+ * - Executes the due actions on each `run` and drops the ones that finish.
+ *
+ * Design Considerations:
+ * - No heap: the actions, the handle table and the free list are members.
+ * - The actions are kept dense at the front of the array; removal moves the last
+ *   action into the freed position, so `run` only visits live actions, at the cost
+ *   of not preserving insertion order after a removal.
+ * - Handles are indices into a table mapping to positions; an index is recycled
+ *   once its action is removed, explicitly or because it finished. Each index
+ *   carries a generation, bumped on removal and encoded in the handle, so a
+ *   stale handle never reaches the action that reused its index.
+ * - `Action::next` is not used, so the scheduler never rewires the actions it holds.
+ */
+
+#ifndef STATIC_SCHEDULER_H
+#define STATIC_SCHEDULER_H
+
+#include "Action.h"
+#include "ExecutionStats.h"
+
+/**
+ * @brief Scheduler backed by a fixed array
+ *
+ * Usage:
+ * @code
+ * StaticScheduler<8> scheduler;
+ * const int blink = scheduler.add(new BlinkLed(LED_BUILTIN));
+ * scheduler.add(new PeriodicCallbackAction(100, 0, 10, [] { Serial.println(F("tick")); }));
+ *
+ * void loop() {
+ *     scheduler.run();          // the 10-shot action is dropped once done
+ *     if (stopBlinking) scheduler.remove(blink);
+ * }
+ * @endcode
+ *
+ * @tparam Capacity Maximum number of actions, below 255.
+ */
+template <uint8_t Capacity>
+class StaticScheduler {
+    static_assert(Capacity > 0 && Capacity < 0xFF, "StaticScheduler capacity must be between 1 and 254");
+
+    static constexpr uint8_t NONE = 0xFF; ///< Position of a free handle.
+
+    Action* actions[Capacity];      ///< Live actions, packed at the front.
+    uint8_t handleOf[Capacity];     ///< Handle of the action at each position.
+    uint8_t positionOf[Capacity];   ///< Position of each handle's action, or `NONE`.
+    uint8_t freeHandles[Capacity];  ///< Stack of unused handle indices.
+    uint8_t generations[Capacity];  ///< Current generation of each handle index, 7 bits so handles fit a 16-bit `int`.
+    uint8_t total{0};               ///< Number of live actions.
+    uint8_t totalFree{Capacity};    ///< Number of unused handles.
+
+    /**
+     * Removes the action at a position by moving the last action into it.
+     *
+     * @param position Position of the action.
+     */
+    void removeAt(const uint8_t position) {
+        const uint8_t handle = handleOf[position];
+        const uint8_t lastPosition = --total;
+        if (position != lastPosition) {
+            actions[position] = actions[lastPosition];
+            handleOf[position] = handleOf[lastPosition];
+            positionOf[handleOf[position]] = position;
+        }
+        positionOf[handle] = NONE;
+        generations[handle] = (generations[handle] + 1) & 0x7F;
+        freeHandles[totalFree++] = handle;
+    }
+
+    /**
+     * Finds the position of a handle's action.
+     *
+     * @param handle Handle returned by `add`.
+     * @return The position, or `NONE` if the handle is invalid or stale.
+     */
+    uint8_t find(const int handle) const {
+        if (handle < 0) return NONE;
+        const uint8_t index = handle & 0xFF;
+        if (index >= Capacity || generations[index] != (handle >> 8)) return NONE;
+        return positionOf[index];
+    }
+
+public:
+    /**
+     * Constructs an empty scheduler.
+     */
+    StaticScheduler() {
+        for (uint8_t i = 0; i < Capacity; i++) {
+            positionOf[i] = NONE;
+            generations[i] = 0;
+            freeHandles[i] = Capacity - 1 - i;
+        }
+    }
+
+    /**
+     * Adds an action.
+     *
+     * @param action The action; it is not owned by the scheduler.
+     * @return The handle of the action, or -1 if the scheduler is full.
+     */
+    int add(Action* action) {
+        if (totalFree == 0) return -1;
+        const uint8_t handle = freeHandles[--totalFree];
+        actions[total] = action;
+        handleOf[total] = handle;
+        positionOf[handle] = total;
+        total++;
+        return (generations[handle] << 8) | handle;
+    }
+
+    /**
+     * Removes an action.
+     *
+     * @param handle Handle returned by `add`.
+     * @return `true` if removed, `false` if the handle holds no action, including
+     *         a handle whose action was already removed or finished.
+     */
+    bool remove(const int handle) {
+        const uint8_t position = find(handle);
+        if (position == NONE) return false;
+        removeAt(position);
+        return true;
+    }
+
+    /**
+     * Retrieves the action of a handle.
+     *
+     * @param handle Handle returned by `add`.
+     * @return The action, or `nullptr` if the handle holds no action.
+     */
+    Action* get(const int handle) const {
+        const uint8_t position = find(handle);
+        return position != NONE ? actions[position] : nullptr;
+    }
+
+    /**
+     * Executes every due action and drops the ones that finish.
+     *
+     * Actions with statistics are timed and their overrun policy applied as in
+     * `Scheduler`, but in array order: after a `SKIP_LOW_PRIORITY` overrun, the
+     * following actions of lower priority are skipped for the rest of the call; a
+     * `DEMOTE` overrun lowers the action to priority 0.
+     */
+    void run() {
+        bool skipping = false;
+        uint8_t floor = 0;
+        for (uint8_t position = 0; position < total;) {
+            Action* action = actions[position];
+            unsigned long wait;
+            if (action->getTimeUntilDue(wait) && wait == 0 && !(skipping && action->getPriority() < floor)) {
+                ExecutionStats* stats = action->getStats();
+                const unsigned long start = stats ? micros() : 0;
+                action->execute();
+                if (stats && stats->record(micros() - start)) {
+                    if (stats->getPolicy() == OverrunPolicy::SKIP_LOW_PRIORITY) {
+                        skipping = true;
+                        if (action->getPriority() > floor) floor = action->getPriority();
+                    } else if (stats->getPolicy() == OverrunPolicy::DEMOTE) {
+                        action->setPriority(0);
+                    }
+                }
+                if (action->isFinished()) {
+                    // The last action moves here and is visited next
+                    removeAt(position);
+                    continue;
+                }
+            }
+            position++;
+        }
+    }
+
+    /**
+     * Retrieves the number of actions.
+     *
+     * @return The live actions.
+     */
+    uint8_t size() const { return total; }
+
+    /**
+     * Checks whether another action fits.
+     *
+     * @return `true` if `add` would fail.
+     */
+    bool isFull() const { return totalFree == 0; }
+
+    // Disallow copy and assignment.
+    StaticScheduler(const StaticScheduler&) = delete;
+    StaticScheduler& operator=(const StaticScheduler&) = delete;
+};
+
+#endif //STATIC_SCHEDULER_H
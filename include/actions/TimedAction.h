@@ -55,6 +55,40 @@ public:
         }
     }
 
+    /**
+     * Restarts the interval; the action will execute once more when it elapses.
+     */
+    void arm() override {
+        executed = false;
+        timerStarted = true;
+        timer.start();
+    }
+
+    /**
+     * Stops the action until `arm` is called again.
+     */
+    void disarm() override {
+        timerStarted = true;
+        timer.stop();
+    }
+
+    /**
+     * Retrieves the time until the action executes.
+     *
+     * @param time Receives the time in milliseconds; 0 means due now.
+     * @return `true` if the action has yet to execute, `false` if it executed or is disarmed.
+     */
+    bool getTimeUntilDue(unsigned long& time) const override {
+        if (executed) return false;
+        if (!timerStarted) {
+            time = 0;
+            return true;
+        }
+        if (!timer.isRunning()) return false;
+        time = timer.remaining();
+        return true;
+    }
+
     /**
      * Checks if the action has been executed.
      *
@@ -63,6 +97,15 @@ public:
     bool isExecuted() const {
         return executed;
     }
+
+    /**
+     * Checks if the action has nothing left to do.
+     *
+     * @return `true` once the action has executed, until it is armed again.
+     */
+    bool isFinished() const override {
+        return executed;
+    }
 };
 
 #endif // TIMED_ACTION_H
\ No newline at end of file
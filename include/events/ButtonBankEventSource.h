@@ -0,0 +1,143 @@
+/**
+ * Event source that debounces a whole bank of buttons in parallel.
+ *
+ * Responsibilities:
+ * - Samples up to 32 inputs at once as a bitmask, either from a port-reading
+ *   function or from a list of pins.
+ * - Debounces every line together with a two-bit vertical counter: a line changes
+ *   state after four consecutive samples at its new level.
+ * - Keeps press and release edge masks and emits them as per-line
+ *   `buttonPressed`/`buttonReleased` events, one per `getEvent` call.
+ *
+ * Design Considerations:
+ * - The whole bank is five 32-bit words, less than a byte of RAM per line, and one
+ *   sample costs a handful of bitwise operations whatever the number of lines.
+ * - Samples are taken every `sampleInterval` milliseconds of `Clock` time, so the
+ *   debounce time is four intervals (20 ms by default).
+ * - Inputs are active low by default, as buttons wired to pull-ups are.
+ */
+
+#ifndef BUTTON_BANK_EVENT_SOURCE_H
+#define BUTTON_BANK_EVENT_SOURCE_H
+
+#include "BaseEventSource.h"
+
+/**
+ * @brief Parallel debouncer for many buttons
+ *
+ * Usage:
+ * @code
+ * uint32_t readPanel() { return PIND | (uint32_t(PINB) << 8); }
+ *
+ * auto panel = new ButtonBankEventSource(readPanel, 16); // lines 0-15
+ * idle->addTransition(new EventTransition(armed, Event::buttonPressed, panel));
+ * // event->getByteValue() is the line (bit) that was pressed
+ * @endcode
+ */
+class ButtonBankEventSource final : public BaseEventSource {
+public:
+    typedef uint32_t (*PortReader)(); ///< Returns the raw level of every line as a bitmask.
+
+private:
+    PortReader reader;            ///< Port reader, or `nullptr` when sampling `pins`.
+    const uint8_t* pins;          ///< Pin of each line, when sampling pins.
+    uint8_t totalPins;            ///< Number of entries in `pins`.
+    uint32_t lines;               ///< Lines in use; the others never change state.
+    uint32_t activeLow;           ///< Lines that read LOW when pressed, within `lines`.
+    unsigned long sampleInterval; ///< Time between samples in milliseconds.
+    unsigned long lastSample;     ///< Time of the last sample.
+    uint32_t state{0};            ///< Debounced pressed lines.
+    uint32_t count0{0};           ///< Low bit of each line's vertical counter.
+    uint32_t count1{0};           ///< High bit of each line's vertical counter.
+    uint32_t pressedEdges{0};     ///< Presses not yet reported.
+    uint32_t releasedEdges{0};    ///< Releases not yet reported.
+
+    uint32_t read() const;
+
+public:
+    /**
+     * Constructs a bank sampled by a port-reading function.
+     *
+     * @param portReader Returns the raw level of every line.
+     * @param count Number of lines, bits 0 to `count - 1` of the reading; at most 32.
+     *              Higher bits are ignored, whatever the reader returns for them.
+     * @param activeLowMask Lines that read LOW when pressed. Defaults to all of them.
+     * @param interval Time between samples in milliseconds.
+     */
+    ButtonBankEventSource(PortReader portReader, uint8_t count, uint32_t activeLowMask = 0xFFFFFFFFUL,
+                          unsigned long interval = 5);
+
+    /**
+     * Constructs a bank sampled from a list of pins. Line `i` is `inputPins[i]`, and
+     * events carry the pin number, as `DebouncedButtonEventSource` events do.
+     *
+     * @param inputPins Pin of each line; must outlive the source.
+     * @param count Number of pins, at most 32.
+     * @param activeLowMask Lines that read LOW when pressed. Defaults to all of them.
+     * @param interval Time between samples in milliseconds.
+     */
+    ButtonBankEventSource(const uint8_t* inputPins, uint8_t count, uint32_t activeLowMask = 0xFFFFFFFFUL,
+                          unsigned long interval = 5);
+
+    /**
+     * Debounces one raw sample of every line and accumulates the resulting edges.
+     *
+     * @param raw Raw level of every line.
+     */
+    void sample(uint32_t raw);
+
+    /**
+     * Samples the bank when due and returns the next pending edge.
+     *
+     * Behavior:
+     * - Presses are reported before releases, lowest line first.
+     * - The byte value is the line, or its pin when the bank was built from pins.
+     *
+     * @return `buttonPressed`, `buttonReleased` or `Event::none`.
+     */
+    Event* getEvent() override;
+
+    /**
+     * Retrieves the debounced state of every line.
+     *
+     * @return Bitmask of the pressed lines.
+     */
+    uint32_t getState() const { return state; }
+
+    /**
+     * Checks whether a line is pressed.
+     *
+     * @param line The line (bit).
+     * @return `true` if its debounced state is pressed.
+     */
+    bool isPressed(const uint8_t line) const { return state & (1UL << line); }
+
+    /**
+     * Retrieves the presses not yet reported by `getEvent`.
+     *
+     * @return Bitmask of the lines pressed since they were last reported.
+     */
+    uint32_t getPressedEdges() const { return pressedEdges; }
+
+    /**
+     * Retrieves the releases not yet reported by `getEvent`.
+     *
+     * @return Bitmask of the lines released since they were last reported.
+     */
+    uint32_t getReleasedEdges() const { return releasedEdges; }
+
+    /**
+     * Takes every pending edge at once, for applications that handle masks.
+     *
+     * @param pressed Receives the pending presses.
+     * @param released Receives the pending releases.
+     */
+    void takeEdges(uint32_t& pressed, uint32_t& released) {
+        pressed = pressedEdges;
+        released = releasedEdges;
+        pressedEdges = 0;
+        releasedEdges = 0;
+    }
+};
+
+#endif //BUTTON_BANK_EVENT_SOURCE_H
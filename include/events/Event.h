@@ -17,6 +17,7 @@ enum class EventType: uint8_t {
     EVENT_BUTTON_RELEASED,
     EVENT_SERIAL_RECEIVED,
     EVENT_SERIAL_SENT,
+    EVENT_FRAME_RECEIVED,
     EVENT_CUSTOM
 };
 
@@ -39,6 +40,8 @@ class Event {
     EventType type{EventType::EVENT_NONE}; ///< Type of the event.
     ValueType valueType{VALUE_NONE};      ///< Type of the associated value.
     GenericValue genValue;                ///< Union storing the event's value.
+    static uint16_t _ids;                 ///< Counter to assign unique IDs to events.
+    uint16_t id{_ids++};                  ///< Dense ID of the event object.
 
 public:
     // Static members representing commonly used events.
@@ -49,6 +52,7 @@ public:
     static Event* buttonReleased;    ///< Represents a button release event.
     static Event* serialReceived;    ///< Represents a serial data received event.
     static Event* serialSent;        ///< Represents a serial data sent event.
+    static Event* frameReceived;     ///< Represents a complete serial frame; the value is its length.
 
     /**
      * Constructs an event with a specified type.
@@ -133,6 +137,23 @@ public:
      */
     EventType getEventType() const;
 
+    /**
+     * Retrieves the dense ID of the event object.
+     *
+     * IDs are assigned in construction order from 0, so they index tables such as
+     * the event-to-column table of an FSM's transition matrix.
+     *
+     * @return The event's ID.
+     */
+    uint16_t getId() const { return id; }
+
+    /**
+     * Retrieves the type of the value carried by the event.
+     *
+     * @return The value type, `VALUE_NONE` if no value was set.
+     */
+    ValueType getValueType() const;
+
     /**
      * Equality operator to compare two events.
      *
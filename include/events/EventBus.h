@@ -0,0 +1,174 @@
+/**
+ * Publish/subscribe distribution of events to many FSMs.
+ *
+ * Responsibilities:
+ * - Polls each registered source exactly once per `poll`, so sources that consume
+ *   their input (serial ports) are read by a single reader.
+ * - Publishes each event on a topic made of its `EventType` and a numeric ID.
+ * - Fans every published event out to the queues of the FSMs subscribed to its topic.
+ *
+ * Design Considerations:
+ * - Sources, subscriptions and the batch are fixed-size arrays allocated once;
+ *   publishing and fan-out never allocate.
+ * - Events are collected into a batch before fan-out, with their values copied, so
+ *   a source overwriting a shared event singleton cannot corrupt an earlier one.
+ * - Subscriptions are kept sorted by topic; each event finds its subscribers with
+ *   a binary search and delivers to a contiguous range.
+ */
+
+#ifndef EVENT_BUS_H
+#define EVENT_BUS_H
+
+#include "EventQueue.h"
+#include "fsm/FSMRuntime.h"
+
+/**
+ * @brief Event bus with topic-based fan-out
+ *
+ * Usage:
+ * @code
+ * EventBus bus(4, 32);
+ * bus.addSource(new SerialInterfaceEventSource(), COMMANDS);
+ * for (auto door : doors) {
+ *     door->setQueue(new EventQueue(4));
+ *     bus.subscribe(door, EventType::EVENT_SERIAL_RECEIVED, COMMANDS);
+ * }
+ *
+ * void loop() {
+ *     bus.poll();
+ *     for (auto door : doors) door->run();
+ * }
+ * @endcode
+ */
+class EventBus {
+public:
+    static constexpr uint16_t ANY_ID = 0xFFFF; ///< Subscribes to every ID of an event type.
+
+private:
+    /**
+     * Registered source and the topic ID of its events.
+     */
+    struct Source {
+        BaseEventSource* source; ///< The source.
+        uint16_t id;             ///< Topic ID of its events.
+    };
+
+    /**
+     * Subscriber of one topic.
+     */
+    struct Subscription {
+        EventType type;          ///< Event type of the topic.
+        uint16_t id;             ///< Topic ID, or `ANY_ID`.
+        FSM* fsm;                ///< Subscribed FSM, when delivered to its queue directly.
+        FSMRuntime* runtime;     ///< Runtime of the FSM, when delivered through it.
+        uint16_t handle;         ///< Handle of the FSM in `runtime`.
+    };
+
+    /**
+     * Event waiting for fan-out.
+     */
+    struct Pending {
+        QueuedEvent event;       ///< The event and its value.
+        uint16_t id;             ///< Topic ID.
+    };
+
+    Source* sources;             ///< Registered sources.
+    uint8_t maxSources;          ///< Capacity of `sources`.
+    uint8_t totalSources{0};     ///< Number of registered sources.
+    Subscription* subscriptions; ///< Subscriptions sorted by topic.
+    uint16_t maxSubscriptions;   ///< Capacity of `subscriptions`.
+    uint16_t totalSubscriptions{0}; ///< Number of subscriptions.
+    Pending* batch;              ///< Events collected by the current `poll`.
+    uint8_t batchSize;           ///< Capacity of `batch`.
+    uint8_t batched{0};          ///< Number of events in `batch`.
+    unsigned long delivered{0};  ///< Events delivered to queues.
+    unsigned long dropped{0};    ///< Deliveries rejected by full queues.
+
+    bool insert(const Subscription& subscription);
+    uint16_t lowerBound(EventType type, uint16_t id) const;
+    void deliver(const QueuedEvent& event, uint16_t id);
+    void flush();
+
+    /**
+     * Orders topics by event type, then ID.
+     */
+    static bool isBefore(const EventType typeA, const uint16_t idA, const EventType typeB, const uint16_t idB) {
+        return typeA != typeB ? typeA < typeB : idA < idB;
+    }
+
+public:
+    /**
+     * Constructs an event bus.
+     *
+     * @param sourceCapacity Maximum number of sources.
+     * @param subscriptionCapacity Maximum number of subscriptions.
+     * @param batchCapacity Events collected before a fan-out.
+     */
+    EventBus(uint8_t sourceCapacity, uint16_t subscriptionCapacity, uint8_t batchCapacity = 16);
+
+    ~EventBus();
+
+    /**
+     * Registers a source polled by `poll`.
+     *
+     * @param source The source.
+     * @param id Topic ID of its events.
+     * @return `true` if registered, `false` if the bus is full.
+     */
+    bool addSource(BaseEventSource* source, uint16_t id = 0);
+
+    /**
+     * Subscribes an FSM to a topic. Events are posted to the FSM's queue.
+     *
+     * @param fsm The subscriber; it must have a queue (see `FSM::setQueue`).
+     * @param type Event type of the topic.
+     * @param id Topic ID, or `ANY_ID`.
+     * @return `true` if subscribed, `false` if the bus is full.
+     */
+    bool subscribe(FSM* fsm, EventType type, uint16_t id = ANY_ID);
+
+    /**
+     * Subscribes an FSM managed by a runtime. Events are posted through the runtime,
+     * which also marks the FSM ready.
+     *
+     * @param runtime The runtime.
+     * @param handle Handle of the FSM in the runtime.
+     * @param type Event type of the topic.
+     * @param id Topic ID, or `ANY_ID`.
+     * @return `true` if subscribed, `false` if the bus is full.
+     */
+    bool subscribe(FSMRuntime* runtime, uint16_t handle, EventType type, uint16_t id = ANY_ID);
+
+    /**
+     * Publishes an event from application code. Delivered on the next `poll`.
+     *
+     * @param event The event, with its current value.
+     * @param id Topic ID.
+     */
+    void publish(Event* event, uint16_t id = 0);
+
+    /**
+     * Polls every source once and fans out the collected events.
+     */
+    void poll();
+
+    /**
+     * Retrieves the number of deliveries made.
+     *
+     * @return The number of events posted to subscriber queues.
+     */
+    unsigned long getDelivered() const { return delivered; }
+
+    /**
+     * Retrieves the number of deliveries that failed because a queue was full.
+     *
+     * @return The number of dropped deliveries.
+     */
+    unsigned long getDropped() const { return dropped; }
+
+    // Disallow copy and assignment.
+    EventBus(const EventBus&) = delete;
+    EventBus& operator=(const EventBus&) = delete;
+};
+
+#endif //EVENT_BUS_H
@@ -0,0 +1,168 @@
+/**
+ * Bounded mailbox of events posted to an FSM.
+ *
+ * Responsibilities:
+ * - Stores posted events, with the value each carried when posted, in arrival order.
+ * - Acts as the event source of the FSM's `EventTransition`s, presenting one
+ *   event per `run()` to every transition that checks it.
+ *
+ * Design Considerations:
+ * - The built-in events are shared singletons whose value is overwritten by each
+ *   `set*Value` call, so the value is copied at `post` and restored when the event
+ *   is delivered.
+ * - Fixed capacity chosen at construction; posting to a full queue fails instead of allocating.
+ */
+
+#ifndef EVENT_QUEUE_H
+#define EVENT_QUEUE_H
+
+#include "BaseEventSource.h"
+
+/**
+ * Event together with the value it carried when it was captured.
+ */
+struct QueuedEvent {
+    Event* event{Event::none};        ///< The captured event.
+    ValueType valueType{VALUE_NONE};  ///< Type of the value.
+    union {
+        int intValue;
+        uint8_t byteValue;
+        float floatValue;
+    };
+
+    QueuedEvent() : intValue{0} { }
+
+    /**
+     * Captures an event and its current value.
+     *
+     * @param source The event to capture.
+     */
+    void capture(Event* source) {
+        event = source;
+        valueType = source->getValueType();
+        switch (valueType) {
+            case VALUE_INT: intValue = source->getIntValue(); break;
+            case VALUE_BYTE: byteValue = source->getByteValue(); break;
+            case VALUE_FLOAT: floatValue = source->getFloatValue(); break;
+            default: break;
+        }
+    }
+
+    /**
+     * Writes the captured value back into the event.
+     *
+     * @return The event, carrying the captured value again.
+     */
+    Event* apply() const {
+        switch (valueType) {
+            case VALUE_INT: event->setIntValue(intValue); break;
+            case VALUE_BYTE: event->setByteValue(byteValue); break;
+            case VALUE_FLOAT: event->setFloatValue(floatValue); break;
+            default: break;
+        }
+        return event;
+    }
+};
+
+/**
+ * @brief FIFO of events feeding one FSM
+ *
+ * Usage:
+ * @code
+ * auto mailbox = new EventQueue(8);
+ * fsm->setQueue(mailbox);
+ * idle->addTransition(new EventTransition(busy, Event::serialReceived, mailbox));
+ * fsm->post(Event::serialReceived->setIntValue('g'));
+ * @endcode
+ */
+class EventQueue final : public BaseEventSource {
+    QueuedEvent* entries;        ///< Ring buffer.
+    uint8_t capacity;            ///< Number of entries.
+    uint8_t head{0};             ///< Index of the oldest entry.
+    uint8_t count{0};            ///< Number of queued entries.
+    Event* current{Event::none}; ///< Event presented during the current cycle.
+    unsigned long dropped{0};    ///< Posts rejected because the queue was full.
+
+public:
+    /**
+     * Constructs an event queue.
+     *
+     * @param size Maximum number of pending events.
+     */
+    explicit EventQueue(const uint8_t size) : entries{new QueuedEvent[size]}, capacity{size} { }
+
+    ~EventQueue() override { delete[] entries; }
+
+    /**
+     * Appends an event, copying its current value.
+     *
+     * @param event The event to post.
+     * @return `true` if queued, `false` if the queue is full.
+     */
+    bool post(Event* event) {
+        if (count >= capacity) {
+            dropped++;
+            return false;
+        }
+        entries[(head + count) % capacity].capture(event);
+        count++;
+        return true;
+    }
+
+    /**
+     * Presents the next queued event, or `Event::none`, for the coming cycle.
+     *
+     * Called by `FSM::run`. An event that no transition of the current state
+     * accepts is discarded.
+     */
+    void advance() {
+        if (count == 0) {
+            current = Event::none;
+            return;
+        }
+        current = entries[head].apply();
+        head = (head + 1) % capacity;
+        count--;
+    }
+
+    /**
+     * Withdraws the event presented for the current cycle once a transition took it.
+     *
+     * Called by `FSM::run` between the hops of a run-to-completion step, so the
+     * event cannot also trigger a transition of the next state.
+     */
+    void consume() {
+        current = Event::none;
+    }
+
+    Event* getEvent() override {
+        return current;
+    }
+
+    /**
+     * Checks whether events are waiting.
+     *
+     * @return `true` if no event is queued, `false` otherwise.
+     */
+    bool isEmpty() const { return count == 0; }
+
+    /**
+     * Retrieves the number of queued events.
+     *
+     * @return The number of events waiting for delivery.
+     */
+    uint8_t getCount() const { return count; }
+
+    /**
+     * Retrieves the number of events rejected because the queue was full.
+     *
+     * @return The number of failed posts.
+     */
+    unsigned long getDropped() const { return dropped; }
+
+    // Disallow copy and assignment.
+    EventQueue(const EventQueue&) = delete;
+    EventQueue& operator=(const EventQueue&) = delete;
+};
+
+#endif //EVENT_QUEUE_H
@@ -0,0 +1,245 @@
+/**
+ * Recording and replay of the events delivered by event sources.
+ *
+ * Responsibilities:
+ * - Records every event an event source returns, with its time, into a compact trace.
+ * - Replays a trace through stand-in event sources driven by the virtual `Clock`,
+ *   as fast as the CPU allows and with the same result on every run.
+ *
+ * Design Considerations:
+ * - Only events are recorded, never "no event" polls, so a trace grows with the
+ *   traffic and not with the loop rate.
+ * - Events are identified by their position in a catalog shared by both sides,
+ *   since the library compares event pointers. The built-in events are always
+ *   in the catalog; custom events are added in the same order on both sides.
+ * - Replay advances the virtual clock one millisecond at a time, so every timer
+ *   expires at the same virtual instant it would have in the field.
+ */
+
+#ifndef EVENT_TRACE_H
+#define EVENT_TRACE_H
+
+#include "BaseEventSource.h"
+#include "actions/Clock.h"
+#include "fsm/SnapshotCodec.h"
+
+/**
+ * @brief Numbered list of the events a trace can contain
+ *
+ * Trace layout: magic "BFET", version byte, then one record per event:
+ * time since the previous record (varint, milliseconds), channel (varint),
+ * `catalogIndex << 2 | valueType`, and the value (byte: 1 byte, int: zigzag
+ * varint, float: 4 bytes, none: nothing). A button press typically takes 4 bytes.
+ */
+class EventCatalog {
+public:
+    static constexpr uint8_t MAX_EVENTS = 32; ///< Capacity of the catalog, built-in events included.
+
+protected:
+    static constexpr uint8_t TRACE_VERSION = 1; ///< Version written after the magic bytes.
+
+    Event* events[MAX_EVENTS]{}; ///< Cataloged events, by index.
+    uint8_t totalEvents{0};      ///< Number of entries in `events`.
+
+    /**
+     * Constructs a catalog holding the built-in events.
+     */
+    EventCatalog();
+
+    /**
+     * Finds the index of an event.
+     *
+     * @param event The event to look up.
+     * @return Its index, or -1 if it is not in the catalog.
+     */
+    int indexOf(const Event* event) const;
+
+public:
+    virtual ~EventCatalog() = default;
+
+    /**
+     * Adds a custom event. Recorder and player must add the same events in the same order.
+     *
+     * @param event The event to add.
+     * @return `true` if added, `false` if the catalog is full.
+     */
+    bool addEvent(Event* event);
+};
+
+/**
+ * @brief Writes a trace of events to a `Print`
+ *
+ * Usage:
+ * @code
+ * EventRecorder recorder(logFile);
+ * auto button = new RecordingEventSource(new DebouncedButtonEventSource(5), &recorder, 0);
+ * recorder.begin();
+ * @endcode
+ */
+class EventRecorder final : public EventCatalog {
+    Print& out;                 ///< Destination of the trace.
+    unsigned long lastTime{0};  ///< Time of the previous record.
+    unsigned long totalRecords{0}; ///< Records written since `begin`.
+    bool recording{false};      ///< Set by `begin`.
+
+public:
+    /**
+     * Constructs a recorder.
+     *
+     * @param output Destination of the trace (serial port, SD file, memory buffer...).
+     */
+    explicit EventRecorder(Print& output) : out{output} { }
+
+    /**
+     * Writes the trace header and starts timing records from now.
+     */
+    void begin();
+
+    /**
+     * Appends an event to the trace. Ignored before `begin` and for uncataloged events.
+     *
+     * @param channel Number of the source that returned the event.
+     * @param event The event returned.
+     */
+    void record(uint8_t channel, const Event* event);
+
+    /**
+     * Retrieves the number of events recorded.
+     *
+     * @return The number of records written since `begin`.
+     */
+    unsigned long getTotalRecords() const { return totalRecords; }
+};
+
+/**
+ * @brief Delivers the events of a trace as virtual time passes
+ *
+ * Usage:
+ * @code
+ * EventPlayer player(trace, traceLength);
+ * auto button = new ReplayEventSource(&player, 0);
+ * player.begin();                 // switches Clock to virtual time
+ * fsm->start();
+ * while (player.step()) fsm->run();
+ * player.end();
+ * @endcode
+ */
+class EventPlayer final : public EventCatalog {
+    SnapshotReader reader;        ///< Cursor over the trace.
+    bool pending{false};          ///< Set while a decoded record waits for delivery.
+    bool delivered{false};        ///< Set when a record was delivered since the last `step`.
+    bool valid{true};             ///< Cleared when the trace is malformed.
+    unsigned long nextTime{0};    ///< Virtual time of the pending record.
+    unsigned long nextChannel{0}; ///< Channel of the pending record.
+    uint8_t nextIndex{0};         ///< Catalog index of the pending event.
+    uint8_t nextValueType{0};     ///< Value type of the pending event.
+    long nextInt{0};              ///< Pending byte or integer value.
+    float nextFloat{0.0f};        ///< Pending float value.
+    unsigned long totalRecords{0};///< Records delivered since `begin`.
+
+    void decodeNext();
+
+public:
+    /**
+     * Constructs a player over a trace held in memory.
+     *
+     * @param trace Bytes written by an `EventRecorder`.
+     * @param length Number of bytes.
+     */
+    EventPlayer(const uint8_t* trace, const size_t length) : reader(trace, length) { }
+
+    /**
+     * Validates the header, switches `Clock` to virtual time and decodes the first record.
+     *
+     * @param start Virtual time at which the trace starts.
+     * @return `true` if the trace header is valid, `false` otherwise.
+     */
+    bool begin(unsigned long start = 0);
+
+    /**
+     * Retrieves the pending event of a channel once its time has come.
+     *
+     * @param channel Number of the requesting source.
+     * @return The event, with its recorded value, or `Event::none`.
+     */
+    Event* take(uint8_t channel);
+
+    /**
+     * Moves virtual time forward by one millisecond, unless more events are due now.
+     *
+     * Call once per pass of the main loop.
+     *
+     * @return `true` while records remain, `false` once the trace is exhausted.
+     */
+    bool step();
+
+    /**
+     * Switches `Clock` back to real time.
+     */
+    void end() { Clock::useReal(); }
+
+    /**
+     * Checks whether the whole trace was decoded without error.
+     *
+     * @return `true` if no malformed record was found, `false` otherwise.
+     */
+    bool isValid() const { return valid; }
+
+    /**
+     * Retrieves the number of events delivered.
+     *
+     * @return The number of records replayed since `begin`.
+     */
+    unsigned long getTotalRecords() const { return totalRecords; }
+};
+
+/**
+ * Event source decorator that records every event of the wrapped source.
+ */
+class RecordingEventSource final : public BaseEventSource {
+    BaseEventSource* source;  ///< Wrapped source.
+    EventRecorder* recorder;  ///< Recorder receiving the events.
+    uint8_t channel;          ///< Channel number of this source in the trace.
+
+public:
+    /**
+     * Constructs a recording source.
+     *
+     * @param wrapped The source to record.
+     * @param traceRecorder Recorder receiving the events.
+     * @param number Channel number, matched by the `ReplayEventSource` that stands in for this source.
+     */
+    RecordingEventSource(BaseEventSource* wrapped, EventRecorder* traceRecorder, const uint8_t number)
+        : source{wrapped}, recorder{traceRecorder}, channel{number} { }
+
+    Event* getEvent() override {
+        Event* event = source->getEvent();
+        if (event != Event::none) {
+            recorder->record(channel, event);
+        }
+        return event;
+    }
+};
+
+/**
+ * Event source that returns the recorded events of one channel.
+ */
+class ReplayEventSource final : public BaseEventSource {
+    EventPlayer* player; ///< Player holding the trace.
+    uint8_t channel;     ///< Channel number of the recorded source.
+
+public:
+    /**
+     * Constructs a replay source.
+     *
+     * @param tracePlayer Player holding the trace.
+     * @param number Channel number of the recorded source.
+     */
+    ReplayEventSource(EventPlayer* tracePlayer, const uint8_t number) : player{tracePlayer}, channel{number} { }
+
+    Event* getEvent() override {
+        return player->take(channel);
+    }
+};
+
+#endif //EVENT_TRACE_H
@@ -0,0 +1,137 @@
+/**
+ * Event source that turns a serial byte stream into complete frames.
+ *
+ * Responsibilities:
+ * - Drains every available byte of the port into a buffer on each poll.
+ * - Splits the bytes into frames (delimiter, length prefix, COBS or SLIP) and
+ *   decodes them in place.
+ * - Emits one `Event::frameReceived` per frame, with a view of the payload.
+ *
+ * Design Considerations:
+ * - Decoding never makes a frame longer, so COBS and SLIP are decoded in place and
+ *   the payload is handed out without copying.
+ * - The buffer is linear rather than circular, so every payload is contiguous.
+ *   Consumed bytes are compacted away only when room is needed for new input.
+ * - The payload view stays valid until the next `getEvent` call.
+ */
+
+#ifndef FRAMED_SERIAL_EVENT_SOURCE_H
+#define FRAMED_SERIAL_EVENT_SOURCE_H
+
+#include "BaseEventSource.h"
+
+/**
+ * Ways of delimiting frames in a byte stream.
+ */
+enum class Framing : uint8_t {
+    DELIMITED,       ///< Frames end with a delimiter byte (default `'\n'`).
+    LENGTH_PREFIXED, ///< A length byte precedes each payload.
+    COBS,            ///< Consistent Overhead Byte Stuffing, frames end with 0x00.
+    SLIP             ///< RFC 1055 framing, frames end with 0xC0.
+};
+
+/**
+ * @brief Framed serial protocol source
+ *
+ * Usage:
+ * @code
+ * auto commands = new FramedSerialEventSource(Framing::DELIMITED, 64);
+ * idle->addTransition(new EventTransition(busy, Event::frameReceived, commands));
+ *
+ * void Busy::onEnter(Event* event) const {
+ *     parse(commands->getPayload(), commands->getPayloadLength());
+ * }
+ * @endcode
+ */
+class FramedSerialEventSource final : public BaseEventSource {
+    Stream& port;                 ///< Port drained by this source.
+    Framing framing;              ///< Framing of the byte stream.
+    uint8_t delimiter{'\n'};      ///< Frame terminator in `DELIMITED` mode.
+    uint8_t* buffer;              ///< Received bytes.
+    size_t capacity;              ///< Size of `buffer`.
+    size_t start{0};              ///< First byte not yet framed.
+    size_t end{0};                ///< One past the last received byte.
+    size_t scan{0};               ///< Where the search for the next terminator resumes.
+    uint8_t* payload{nullptr};    ///< Payload of the last frame.
+    size_t payloadLength{0};      ///< Length of the last frame.
+    bool resynchronizing{false};  ///< Dropping the tail of an overlong frame.
+    unsigned long frames{0};      ///< Frames delivered.
+    unsigned long errors{0};      ///< Frames discarded as malformed.
+    unsigned long overflows{0};   ///< Times the buffer filled up without a complete frame.
+
+    void drain();
+    bool nextFrame();
+    static bool decodeCobs(uint8_t* data, size_t& length);
+    static bool decodeSlip(uint8_t* data, size_t& length);
+
+public:
+    /**
+     * Constructs a framed serial source.
+     *
+     * @param mode Framing of the byte stream.
+     * @param bufferSize Buffer size; must hold the longest encoded frame.
+     * @param stream Port to read. Defaults to `Serial`.
+     */
+    explicit FramedSerialEventSource(Framing mode, size_t bufferSize = 64, Stream& stream = Serial);
+
+    ~FramedSerialEventSource() override { delete[] buffer; }
+
+    /**
+     * Sets the frame terminator used in `DELIMITED` mode.
+     *
+     * @param terminator The delimiter byte.
+     * @return A pointer to this source for method chaining.
+     */
+    FramedSerialEventSource* setDelimiter(const uint8_t terminator) {
+        delimiter = terminator;
+        return this;
+    }
+
+    /**
+     * Drains the port and returns the next complete frame, if any.
+     *
+     * @return `Event::frameReceived` carrying the payload length, or `Event::none`.
+     */
+    Event* getEvent() override;
+
+    /**
+     * Retrieves the payload of the last frame.
+     *
+     * @return Pointer to the decoded payload, valid until the next `getEvent`.
+     */
+    const uint8_t* getPayload() const { return payload; }
+
+    /**
+     * Retrieves the length of the last frame.
+     *
+     * @return The payload length in bytes.
+     */
+    size_t getPayloadLength() const { return payloadLength; }
+
+    /**
+     * Retrieves the number of frames delivered.
+     *
+     * @return The number of `frameReceived` events returned.
+     */
+    unsigned long getFrames() const { return frames; }
+
+    /**
+     * Retrieves the number of malformed frames discarded.
+     *
+     * @return The number of decoding errors.
+     */
+    unsigned long getErrors() const { return errors; }
+
+    /**
+     * Retrieves the number of buffer overflows.
+     *
+     * @return The number of times buffered bytes were discarded to resynchronize.
+     */
+    unsigned long getOverflows() const { return overflows; }
+
+    // Disallow copy and assignment.
+    FramedSerialEventSource(const FramedSerialEventSource&) = delete;
+    FramedSerialEventSource& operator=(const FramedSerialEventSource&) = delete;
+};
+
+#endif //FRAMED_SERIAL_EVENT_SOURCE_H
@@ -0,0 +1,203 @@
+/**
+ * Single reader of a serial port that routes its bytes to logical channels.
+ *
+ * Responsibilities:
+ * - Drains the port in one place, so sources sharing a UART never steal each
+ *   other's bytes.
+ * - Routes each byte to the first channel whose rule matches: a character set, a
+ *   character range, or a prefix byte that claims the rest of the frame.
+ * - Exposes each channel as a `Stream`, so any serial event source can read it.
+ *
+ * Design Considerations:
+ * - Channels are small ring buffers allocated once when they are added.
+ * - A channel drains the port on demand when its reader finds it empty, so no
+ *   extra call is needed in `loop()`; `poll` can still be called explicitly.
+ * - Writes to a channel go straight to the shared port.
+ */
+
+#ifndef SERIAL_DEMUX_H
+#define SERIAL_DEMUX_H
+
+#include <Arduino.h>
+
+class SerialDemux;
+
+/**
+ * @brief Logical serial port fed by a `SerialDemux`
+ */
+class SerialChannel final : public Stream {
+    friend class SerialDemux;
+
+    SerialDemux& demux;           ///< Demultiplexer feeding this channel.
+    uint8_t* buffer;              ///< Received bytes.
+    uint8_t capacity;             ///< Size of `buffer`.
+    uint8_t head{0};              ///< Position of the oldest byte.
+    uint8_t count{0};             ///< Number of buffered bytes.
+    unsigned long dropped{0};     ///< Bytes lost because the buffer was full.
+
+    SerialChannel(SerialDemux& owner, uint8_t bufferSize);
+    void push(uint8_t byte);
+
+public:
+    ~SerialChannel() override { delete[] buffer; }
+
+    /**
+     * Retrieves the number of buffered bytes, draining the port first if empty.
+     *
+     * @return The number of bytes that can be read.
+     */
+    int available() override;
+
+    /**
+     * Reads the oldest buffered byte.
+     *
+     * @return The byte, or -1 if none is available.
+     */
+    int read() override;
+
+    /**
+     * Returns the oldest buffered byte without consuming it.
+     *
+     * @return The byte, or -1 if none is available.
+     */
+    int peek() override;
+
+    /**
+     * Writes a byte to the shared port.
+     *
+     * @param byte The byte.
+     * @return The number of bytes written.
+     */
+    size_t write(uint8_t byte) override;
+    using Print::write;
+
+    /**
+     * Retrieves the number of bytes lost to a full buffer.
+     *
+     * @return The number of dropped bytes.
+     */
+    unsigned long getDropped() const { return dropped; }
+
+    // Disallow copy and assignment.
+    SerialChannel(const SerialChannel&) = delete;
+    SerialChannel& operator=(const SerialChannel&) = delete;
+};
+
+/**
+ * @brief Serial port demultiplexer
+ *
+ * Usage:
+ * @code
+ * auto demux = new SerialDemux(3);
+ * auto buttons = new FakeSerialButtonEventSource('A', 'S', *demux->addChannel("AS"));
+ * auto digits = new SerialInterfaceEventSource(0, *demux->addChannel('0', '9'));
+ * auto commands = new FramedSerialEventSource(Framing::DELIMITED, 32, *demux->addPrefixedChannel('$'));
+ * @endcode
+ */
+class SerialDemux {
+    /**
+     * Kinds of routing rules.
+     */
+    enum class RouteKind : uint8_t {
+        CHARACTERS,              ///< Bytes found in a character set.
+        RANGE,                   ///< Bytes between two values, inclusive.
+        PREFIX                   ///< The prefix byte opens a frame that runs to the terminator.
+    };
+
+    /**
+     * Routing rule of one channel.
+     */
+    struct Route {
+        RouteKind kind;          ///< Kind of rule.
+        uint8_t first;           ///< Lower bound, or the prefix byte.
+        uint8_t last;            ///< Upper bound.
+        const char* characters;  ///< Character set.
+        SerialChannel* channel;  ///< Destination.
+    };
+
+    Stream& port;                ///< Port drained by this demultiplexer.
+    uint8_t terminator;          ///< End of a prefixed frame.
+    Route* routes;               ///< Routing rules, in the order they were added.
+    uint8_t maxRoutes;           ///< Capacity of `routes`.
+    uint8_t totalRoutes{0};      ///< Number of routing rules.
+    SerialChannel* fallback{nullptr}; ///< Destination of unmatched bytes.
+    SerialChannel* frame{nullptr};    ///< Channel owning the frame in progress.
+    unsigned long unrouted{0};   ///< Bytes that matched no channel.
+
+    SerialChannel* add(const Route& route, uint8_t bufferSize);
+    void route(uint8_t byte);
+
+public:
+    /**
+     * Constructs a demultiplexer.
+     *
+     * @param maxChannels Maximum number of routed channels.
+     * @param stream Port to drain. Defaults to `Serial`.
+     * @param frameTerminator Byte that ends a prefixed frame. Defaults to `'\n'`.
+     */
+    explicit SerialDemux(uint8_t maxChannels, Stream& stream = Serial, uint8_t frameTerminator = '\n');
+
+    ~SerialDemux();
+
+    /**
+     * Adds a channel receiving every byte found in a character set.
+     *
+     * @param characters The character set; must outlive the demultiplexer.
+     * @param bufferSize Channel buffer size.
+     * @return The channel, or `nullptr` if the demultiplexer is full.
+     */
+    SerialChannel* addChannel(const char* characters, uint8_t bufferSize = 16);
+
+    /**
+     * Adds a channel receiving every byte in a range, such as `'0'` to `'9'`.
+     *
+     * @param first Lowest byte value.
+     * @param last Highest byte value.
+     * @param bufferSize Channel buffer size.
+     * @return The channel, or `nullptr` if the demultiplexer is full.
+     */
+    SerialChannel* addChannel(uint8_t first, uint8_t last, uint8_t bufferSize = 16);
+
+    /**
+     * Adds a channel receiving frames that start with a prefix byte. The prefix is
+     * removed; the rest of the frame, terminator included, goes to the channel.
+     *
+     * @param prefix Frame header byte.
+     * @param bufferSize Channel buffer size.
+     * @return The channel, or `nullptr` if the demultiplexer is full.
+     */
+    SerialChannel* addPrefixedChannel(uint8_t prefix, uint8_t bufferSize = 32);
+
+    /**
+     * Sets up the channel receiving every byte no rule matched.
+     *
+     * @param bufferSize Channel buffer size.
+     * @return The channel.
+     */
+    SerialChannel* addDefaultChannel(uint8_t bufferSize = 16);
+
+    /**
+     * Drains every available byte of the port into the channels.
+     */
+    void poll();
+
+    /**
+     * Retrieves the number of bytes that matched no channel.
+     *
+     * @return The number of discarded bytes.
+     */
+    unsigned long getUnrouted() const { return unrouted; }
+
+    /**
+     * Retrieves the shared port.
+     *
+     * @return The port drained by this demultiplexer.
+     */
+    Stream& getPort() const { return port; }
+
+    // Disallow copy and assignment.
+    SerialDemux(const SerialDemux&) = delete;
+    SerialDemux& operator=(const SerialDemux&) = delete;
+};
+
+#endif //SERIAL_DEMUX_H
@@ -23,19 +23,24 @@
  */
 class SerialInterfaceEventSource: public BaseEventSource {
     int expectedChar;
+    Stream& port; ///< Serial port read by this source.
 public:
     /**
      * Constructs a serial interface event source.
+     *
+     * @param expectedChar Character to report, or 0 to report every byte.
+     * @param stream Port to read. Defaults to `Serial`.
      */
 
-    explicit SerialInterfaceEventSource(const int expectedChar = 0): expectedChar{expectedChar} { }
+    explicit SerialInterfaceEventSource(const int expectedChar = 0, Stream& stream = Serial)
+        : expectedChar{expectedChar}, port{stream} { }
 
     /**
      * @brief Checks for and processes serial input events
      * @return Event* Pointer to an Event object or Event::none
      *
      * This function performs the following:
-     * 1. Checks if data is available on the Serial port
+     * 1. Checks if data is available on the port
      * 2. If data is available, it reads one byte
      * 3. If no specific character is expected (expectedChar == 0),
      *    it returns a serialReceived event with the read byte
@@ -46,8 +51,8 @@ public:
      * @note This function overrides a base class method
      */
     Event* getEvent() override {
-        if (Serial.available() > 0) {
-            const int received = Serial.read();
+        if (port.available() > 0) {
+            const int received = port.read();
             if (expectedChar == 0) {
                 return Event::serialReceived->setIntValue(received);
             }
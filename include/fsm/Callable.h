@@ -0,0 +1,186 @@
+/**
+ * Fixed-size, heap-free type-erased callable.
+ *
+ * Responsibilities:
+ * - Stores a function pointer, functor or capturing lambda inline, in a buffer
+ *   of a size chosen at compile time.
+ * - Calls it through a single function pointer, with no virtual dispatch and no allocation.
+ *
+ * Design Considerations:
+ * - A target larger than the buffer is a compile-time error, never a silent heap fallback.
+ * - Does not depend on the C++ standard library, which most AVR toolchains lack;
+ *   only placement new is needed.
+ */
+
+#ifndef CALLABLE_H
+#define CALLABLE_H
+
+#include <Arduino.h>
+
+#if defined(__has_include)
+    #if __has_include(<new>)
+        #include <new>
+    #else
+        #include <new.h>
+    #endif
+#else
+    #include <new.h>
+#endif
+
+/**
+ * Default inline capacity: room for two pointers (e.g. an object and a pin, or two thresholds).
+ */
+#ifndef FSM_CALLABLE_SIZE
+    #define FSM_CALLABLE_SIZE (2 * sizeof(void*))
+#endif
+
+template <typename Signature, size_t Size = FSM_CALLABLE_SIZE>
+class Callable;
+
+/**
+ * @brief In-place callable with a fixed-size buffer
+ *
+ * Usage:
+ * @code
+ * const uint8_t pin = 7;
+ * const int threshold = 512;
+ * Callable<bool()> guard = [pin, threshold] { return analogRead(pin) > threshold; };
+ * if (guard) guard();
+ * @endcode
+ *
+ * @tparam R Return type.
+ * @tparam Args Argument types.
+ * @tparam Size Inline capacity in bytes.
+ */
+template <typename R, typename... Args, size_t Size>
+class Callable<R(Args...), Size> {
+    /**
+     * Operations on the stored target, one table per target type.
+     */
+    struct Operations {
+        R (*invoke)(void* target, Args... args);       ///< Calls the target.
+        void (*copy)(void* destination, const void* source); ///< Copy-constructs the target into `destination`.
+        void (*destroy)(void* target);                 ///< Destroys the target.
+    };
+
+    /**
+     * Operations for targets of type `Target`.
+     */
+    template <typename Target>
+    struct OperationsFor {
+        static R invoke(void* target, Args... args) { return (*static_cast<Target*>(target))(args...); }
+        static void copy(void* destination, const void* source) { new (destination) Target(*static_cast<const Target*>(source)); }
+        static void destroy(void* target) { static_cast<Target*>(target)->~Target(); }
+        static const Operations table;
+    };
+
+    union Storage {
+        void* pointer;              ///< Forces pointer alignment.
+        long integer;               ///< Forces long alignment.
+        double real;                ///< Forces double alignment.
+        unsigned char bytes[Size];  ///< Inline buffer.
+    };
+
+    Storage storage;                      ///< Holds the target.
+    const Operations* operations{nullptr}; ///< Operations of the stored type, `nullptr` if empty.
+
+    template <typename Target>
+    void assign(const Target& function) {
+        static_assert(sizeof(Target) <= Size, "Callable target does not fit the inline buffer; increase Size");
+        static_assert(alignof(Target) <= alignof(Storage), "Callable target is over-aligned");
+        new (storage.bytes) Target(function);
+        operations = &OperationsFor<Target>::table;
+    }
+
+    void reset() {
+        if (operations) {
+            operations->destroy(storage.bytes);
+            operations = nullptr;
+        }
+    }
+
+public:
+    /**
+     * Constructs an empty callable.
+     */
+    Callable() { }
+
+    /**
+     * Constructs a callable from a plain function. A null pointer gives an empty callable.
+     *
+     * @param function The function to call.
+     */
+    Callable(R (*function)(Args...)) {
+        if (function) assign(function);
+    }
+
+    /**
+     * Constructs an empty callable from `nullptr`.
+     */
+    Callable(decltype(nullptr)) { }
+
+    /**
+     * Constructs a callable from a functor or lambda, copied into the inline buffer.
+     *
+     * @param function The functor to call.
+     */
+    template <typename Target>
+    Callable(Target function) {
+        assign(function);
+    }
+
+    Callable(const Callable& other) : operations{other.operations} {
+        if (operations) operations->copy(storage.bytes, other.storage.bytes);
+    }
+
+    Callable& operator=(const Callable& other) {
+        if (this != &other) {
+            reset();
+            if (other.operations) {
+                other.operations->copy(storage.bytes, other.storage.bytes);
+                operations = other.operations;
+            }
+        }
+        return *this;
+    }
+
+    ~Callable() { reset(); }
+
+    /**
+     * Calls the target. Must not be called on an empty callable.
+     *
+     * @param args Arguments forwarded to the target.
+     * @return The target's result.
+     */
+    R operator()(Args... args) const {
+        return operations->invoke(const_cast<unsigned char*>(storage.bytes), args...);
+    }
+
+    /**
+     * Checks whether a target is stored.
+     *
+     * @return `true` if callable, `false` if empty.
+     */
+    explicit operator bool() const { return operations != nullptr; }
+
+    /**
+     * Retrieves the stored target if it has type `Target`.
+     *
+     * @tparam Target Expected target type, e.g. `bool (*)()` for a plain function.
+     * @return Pointer to the target, or `nullptr` if empty or of another type.
+     */
+    template <typename Target>
+    const Target* target() const {
+        return operations == &OperationsFor<Target>::table ? reinterpret_cast<const Target*>(storage.bytes) : nullptr;
+    }
+};
+
+template <typename R, typename... Args, size_t Size>
+template <typename Target>
+const typename Callable<R(Args...), Size>::Operations Callable<R(Args...), Size>::OperationsFor<Target>::table = {
+    &Callable<R(Args...), Size>::OperationsFor<Target>::invoke,
+    &Callable<R(Args...), Size>::OperationsFor<Target>::copy,
+    &Callable<R(Args...), Size>::OperationsFor<Target>::destroy
+};
+
+#endif //CALLABLE_H
@@ -0,0 +1,94 @@
+/**
+ * State whose hooks are lambdas instead of overridden methods.
+ *
+ * Responsibilities:
+ * - Runs optional entry, exit and update callables around the base `State` behavior.
+ *
+ * Design Considerations:
+ * - Hooks are stored inline (see `Callable`), so a state needs no subclass and
+ *   no extra allocation to carry its context.
+ */
+
+#ifndef CALLBACK_STATE_H
+#define CALLBACK_STATE_H
+
+#include "State.h"
+#include "Callable.h"
+
+/**
+ * @brief State configured with callables
+ *
+ * Usage:
+ * @code
+ * auto ledOn = (new CallbackState(1000))
+ *     ->whenEntered([](Event*) { digitalWrite(LED_PIN, HIGH); })
+ *     ->whenExited([](Event*) { digitalWrite(LED_PIN, LOW); });
+ * @endcode
+ */
+class CallbackState final : public State {
+public:
+    typedef Callable<void(Event*)> Hook;  ///< Entry or exit hook.
+    typedef Callable<void()> UpdateHook;  ///< Update hook.
+
+private:
+    Hook enterHook;        ///< Runs after the state is entered.
+    Hook exitHook;         ///< Runs before the state is left.
+    UpdateHook updateHook; ///< Runs on every cycle without transition.
+
+public:
+    /**
+     * Constructs a state with an optional timeout duration.
+     *
+     * @param timeout Timeout duration in milliseconds. Defaults to 0 (no timeout).
+     */
+    explicit CallbackState(const unsigned long timeout = 0) : State(timeout) { }
+
+    /**
+     * Sets the entry hook.
+     *
+     * @param hook Callable receiving the triggering event (can be `nullptr`).
+     * @return A pointer to this state for method chaining.
+     */
+    CallbackState* whenEntered(const Hook& hook) {
+        enterHook = hook;
+        return this;
+    }
+
+    /**
+     * Sets the exit hook.
+     *
+     * @param hook Callable receiving the triggering event (can be `nullptr`).
+     * @return A pointer to this state for method chaining.
+     */
+    CallbackState* whenExited(const Hook& hook) {
+        exitHook = hook;
+        return this;
+    }
+
+    /**
+     * Sets the update hook.
+     *
+     * @param hook Callable run while the state is active and no transition fires.
+     * @return A pointer to this state for method chaining.
+     */
+    CallbackState* whileActive(const UpdateHook& hook) {
+        updateHook = hook;
+        return this;
+    }
+
+    void onEnter(Event* event) const override {
+        State::onEnter(event);
+        if (enterHook) enterHook(event);
+    }
+
+    void onExit(Event* event) const override {
+        if (exitHook) exitHook(event);
+        State::onExit(event);
+    }
+
+    void onUpdate() const override {
+        if (updateHook) updateHook();
+    }
+};
+
+#endif //CALLBACK_STATE_H
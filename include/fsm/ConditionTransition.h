@@ -6,6 +6,9 @@
 #define CONDITION_TRANSITION_H
 
 #include "Transition.h"
+#include "GuardInput.h"
+#include "Callable.h"
+
 /**
  * @brief Condition-based transition
  *
@@ -15,7 +18,7 @@
  * Key features:
  * - Boolean condition evaluation
  * - Highest transition priority
- * - Custom condition functions
+ * - Custom condition functions, or lambdas whose captures are stored inline
  *
  * Usage:
  * @code
@@ -23,28 +26,132 @@
  *     nextState,
  *     []() { return digitalRead(PIN) == HIGH; }
  * ));
+ *
+ * // Context travels in the capture, without globals or heap
+ * state->addTransition(new ConditionTransition(
+ *     nextState,
+ *     [sensor, threshold]() { return sensor->read() > threshold; }
+ * ));
  * @endcode
+ *
+ * Declaring the inputs of a guard with `dependsOn` lets the transition reuse its
+ * last result until one of them changes, so idle ticks skip expensive guards
+ * (sensor reads over I2C, floating-point math):
+ * @code
+ * Signal<float> pressure;
+ * state->addTransition((new ConditionTransition(alarm, [] { return pressure > limit(); }))
+ *     ->dependsOn(&pressure));
+ * @endcode
+ *
+ * @note A guard with declared inputs must depend on nothing else: reading the
+ * clock or an undeclared variable would leave a stale cached result.
  */
 class ConditionTransition final : public Transition {
-    bool (*condition)();  ///< Pointer to a condition function.
+public:
+    /**
+     * Guard type: a plain function or a lambda with up to `FSM_CALLABLE_SIZE` bytes of captures.
+     */
+    typedef Callable<bool()> Guard;
+
+private:
+    /**
+     * Declared input and the change counter the guard last saw.
+     */
+    struct Dependency {
+        GuardInput* input;  ///< The input.
+        uint8_t seen;       ///< Value of `input->getVersion()` at the last evaluation.
+        Dependency* next;   ///< Next dependency of the same guard.
+    };
+
+    Guard condition;      ///< Condition, stored inline.
+    Dependency* dependencies{nullptr}; ///< Declared inputs, or `nullptr` to evaluate on every check.
+    bool cached{false};   ///< Set once `result` holds a valid evaluation.
+    bool result{false};   ///< Result of the last evaluation.
+
+    /**
+     * Checks whether any declared input changed since the last evaluation.
+     *
+     * Refreshes every input and records its current counter.
+     *
+     * @return `true` if the guard must be evaluated again, `false` otherwise.
+     */
+    bool isDirty() {
+        bool dirty = !cached;
+        for (Dependency* dependency = dependencies; dependency; dependency = dependency->next) {
+            dependency->input->refresh();
+            const uint8_t version = dependency->input->getVersion();
+            if (version != dependency->seen) {
+                dependency->seen = version;
+                dirty = true;
+            }
+        }
+        return dirty;
+    }
 
 public:
     /**
      * Constructs a condition transition.
      *
      * @param next Pointer to the next state.
-     * @param cond Pointer to the condition function.
+     * @param cond Condition function or lambda.
+     */
+    ConditionTransition(State* next, const Guard& cond)
+        : Transition(next, CONDITION_TRANSITION, true), condition{cond} { }
+
+    ~ConditionTransition() override {
+        while (dependencies) {
+            Dependency* next = dependencies->next;
+            delete dependencies;
+            dependencies = next;
+        }
+    }
+
+    /**
+     * Retrieves the condition when it is a plain function.
+     *
+     * @return Pointer to the condition function, or `nullptr` if none or if the condition is a lambda with captures.
+     */
+    bool (*getCondition() const)() {
+        bool (* const* function)() = condition.target<bool (*)()>();
+        return function ? *function : nullptr;
+    }
+
+    /**
+     * Checks whether a condition is set.
+     *
+     * @return `true` if the transition has a condition, `false` otherwise.
      */
-    ConditionTransition(State* next, bool (*cond)())
-        : Transition(next), condition{cond} { }
+    bool hasCondition() const { return static_cast<bool>(condition); }
 
-    TransitionPriority getPriority() const override { return CONDITION_TRANSITION; }
+    /**
+     * Declares an input of the guard. Once at least one input is declared, the
+     * guard only runs again after one of them changed.
+     *
+     * @param input The input the condition reads.
+     * @return A pointer to this transition for method chaining.
+     */
+    ConditionTransition* dependsOn(GuardInput* input) {
+        dependencies = new Dependency{input, input->getVersion(), dependencies};
+        cached = false;
+        return this;
+    }
+
+    /**
+     * Checks whether the guard declared its inputs.
+     *
+     * @return `true` if results are cached between input changes, `false` otherwise.
+     */
+    bool hasDependencies() const { return dependencies != nullptr; }
 
     bool isTriggered() override {
-        if (condition && condition()) {
-            return true;
+        if (!condition) return false;
+        if (!dependencies) return condition();
+
+        if (isDirty()) {
+            result = condition();
+            cached = true;
         }
-        return false;
+        return result;
     }
 };
 
@@ -0,0 +1,334 @@
+/**
+ * States whose behavior is written as a C++20 coroutine.
+ *
+ * Responsibilities:
+ * - Runs a sequential behavior (`co_await fsm::delay(ms)`, `fsm::event(e)`,
+ *   `fsm::until(condition)`) inside a single state, instead of one state and one
+ *   timeout transition per step.
+ * - Starts the coroutine when the state is entered, resumes it when what it awaits
+ *   has happened, and destroys it when the state is exited.
+ * - Allocates coroutine frames from a fixed pool, never from the heap.
+ *
+ * Design Considerations:
+ * - The coroutine is driven by a state-scoped action (see `State::addAction`), so it
+ *   resumes from `FSM::run` and a delay is a deadline that `FSMRuntime` sleeps until.
+ *   Event and condition waits set no deadline: under `FSMRuntime` such an FSM must be
+ *   polled, or woken when what it waits for may have happened.
+ * - Consecutive delays are chained from the previous deadline rather than from the
+ *   step that noticed it, so a loop of delays does not drift with the polling rate.
+ * - Only available with a compiler and library supporting C++20 coroutines; on other
+ *   toolchains, such as AVR, the header declares nothing.
+ * - The pool holds `FSM_COROUTINE_FRAMES` frames of `FSM_COROUTINE_FRAME_SIZE` bytes.
+ *   A behavior whose frame does not fit, or that finds the pool empty, does not run.
+ */
+
+#ifndef COROUTINE_STATE_H
+#define COROUTINE_STATE_H
+
+#if defined(__has_include)
+#if __has_include(<coroutine>) && defined(__cpp_impl_coroutine)
+#define FSM_COROUTINES 1
+#endif
+#endif
+
+#ifdef FSM_COROUTINES
+
+#include <coroutine>
+#include "State.h"
+#include "Callable.h"
+#include "events/BaseEventSource.h"
+
+#ifndef FSM_COROUTINE_FRAMES
+#define FSM_COROUTINE_FRAMES 4
+#endif
+
+#ifndef FSM_COROUTINE_FRAME_SIZE
+#define FSM_COROUTINE_FRAME_SIZE 384
+#endif
+
+namespace fsm {
+
+/**
+ * @brief Fixed pool of coroutine frames
+ */
+class FramePool {
+public:
+    /**
+     * Takes a free frame.
+     *
+     * @param size Size requested by the compiler.
+     * @return The frame, or `nullptr` if it is too large or none is free.
+     */
+    static void* allocate(size_t size) noexcept;
+
+    /**
+     * Returns a frame to the pool.
+     *
+     * @param frame Frame returned by `allocate`.
+     */
+    static void release(void* frame) noexcept;
+
+    /**
+     * Retrieves the number of free frames.
+     *
+     * @return Frames available for new behaviors.
+     */
+    static uint8_t getFree() noexcept;
+
+    /**
+     * Retrieves the number of failed allocations.
+     *
+     * @return Behaviors that could not start because their frame was too large or
+     *         the pool was empty.
+     */
+    static unsigned long getFailures() noexcept;
+};
+
+/**
+ * @brief What a suspended behavior is waiting for
+ *
+ * Created by `delay`, `event` and `until`, and consumed by `co_await`.
+ */
+struct Wait {
+    /**
+     * Kinds of waits.
+     */
+    enum Kind : uint8_t {
+        DELAY,                     ///< A time interval.
+        EVENT,                     ///< An event from a source.
+        UNTIL                      ///< A condition becoming true.
+    };
+
+    Kind kind{DELAY};              ///< Kind of wait.
+    unsigned long duration{0};     ///< Interval of a `DELAY`, in milliseconds.
+    Event* event{nullptr};         ///< Event awaited by an `EVENT`.
+    BaseEventSource* source{nullptr}; ///< Source of the event, or the state's default.
+    Callable<bool()> condition;    ///< Condition of an `UNTIL`.
+    Event* received{nullptr};      ///< Event that ended an `EVENT`.
+
+    bool await_ready() const noexcept { return false; }
+
+    template <typename Promise>
+    void await_suspend(std::coroutine_handle<Promise> handle) noexcept {
+        handle.promise().waiting = this;
+    }
+
+    /**
+     * @return The event that ended an `EVENT` wait, `nullptr` for other waits.
+     */
+    Event* await_resume() const noexcept { return received; }
+};
+
+/**
+ * @brief Coroutine type of a state behavior
+ *
+ * Owns the coroutine frame; moving transfers it, destruction releases it.
+ */
+class Behavior {
+public:
+    /**
+     * Promise of a behavior: records the current wait and allocates from `FramePool`.
+     */
+    struct promise_type {
+        Wait* waiting{nullptr};    ///< Wait the behavior is suspended on.
+
+        Behavior get_return_object() noexcept {
+            return Behavior(std::coroutine_handle<promise_type>::from_promise(*this));
+        }
+        static Behavior get_return_object_on_allocation_failure() noexcept { return Behavior(); }
+        std::suspend_always initial_suspend() noexcept { return {}; }
+        std::suspend_always final_suspend() noexcept { return {}; }
+        void return_void() noexcept { waiting = nullptr; }
+        void unhandled_exception() noexcept { }
+
+        static void* operator new(const size_t size) noexcept { return FramePool::allocate(size); }
+        static void operator delete(void* frame) noexcept { FramePool::release(frame); }
+    };
+
+    Behavior() = default;
+    explicit Behavior(const std::coroutine_handle<promise_type> coroutine) : handle{coroutine} { }
+    Behavior(Behavior&& other) noexcept : handle{other.handle} { other.handle = nullptr; }
+    Behavior& operator=(Behavior&& other) noexcept {
+        if (this != &other) {
+            reset();
+            handle = other.handle;
+            other.handle = nullptr;
+        }
+        return *this;
+    }
+    ~Behavior() { reset(); }
+
+    /**
+     * Destroys the coroutine, if any.
+     */
+    void reset() {
+        if (handle) {
+            handle.destroy();
+            handle = nullptr;
+        }
+    }
+
+    /**
+     * Checks whether a coroutine is attached and has not finished.
+     *
+     * @return `true` if the behavior can still be resumed.
+     */
+    bool isActive() const { return handle && !handle.done(); }
+
+    /**
+     * Checks whether the coroutine ran to its end.
+     *
+     * @return `true` if the behavior finished.
+     */
+    bool isDone() const { return handle && handle.done(); }
+
+    /**
+     * Retrieves the wait the coroutine is suspended on.
+     *
+     * @return The wait, or `nullptr` if it is not suspended on one.
+     */
+    Wait* getWait() const { return isActive() ? handle.promise().waiting : nullptr; }
+
+    /**
+     * Resumes the coroutine until its next suspension.
+     */
+    void resume() const {
+        if (isActive()) {
+            handle.promise().waiting = nullptr;
+            handle.resume();
+        }
+    }
+
+    Behavior(const Behavior&) = delete;
+    Behavior& operator=(const Behavior&) = delete;
+
+private:
+    std::coroutine_handle<promise_type> handle{nullptr}; ///< The coroutine.
+};
+
+/**
+ * Suspends a behavior for a time interval, counted from the end of the previous delay
+ * when it directly follows one, otherwise from the suspension.
+ *
+ * @param milliseconds Interval in milliseconds.
+ * @return The wait to `co_await`.
+ */
+inline Wait delay(const unsigned long milliseconds) {
+    Wait wait;
+    wait.kind = Wait::DELAY;
+    wait.duration = milliseconds;
+    return wait;
+}
+
+/**
+ * Suspends a behavior until an event is received.
+ *
+ * @param event The awaited event.
+ * @param source Source to poll, or `nullptr` for the state's default source.
+ * @return The wait to `co_await`; it resumes with the received event.
+ */
+inline Wait event(Event* event, BaseEventSource* source = nullptr) {
+    Wait wait;
+    wait.kind = Wait::EVENT;
+    wait.event = event;
+    wait.source = source;
+    return wait;
+}
+
+/**
+ * Suspends a behavior until a condition is true. The condition is checked on every `run`.
+ *
+ * @param condition The condition.
+ * @return The wait to `co_await`.
+ */
+inline Wait until(const Callable<bool()>& condition) {
+    Wait wait;
+    wait.kind = Wait::UNTIL;
+    wait.condition = condition;
+    return wait;
+}
+
+} // namespace fsm
+
+/**
+ * @brief State running a coroutine behavior
+ *
+ * Usage:
+ * @code
+ * class Blinker final : public CoroutineState {
+ *     fsm::Behavior behave() override {
+ *         static const uint8_t leds[] = { LED1, LED2, LED3 };
+ *         for (uint8_t pin : leds) {
+ *             digitalWrite(pin, HIGH);
+ *             co_await fsm::delay(1000);
+ *             digitalWrite(pin, LOW);
+ *         }
+ *         co_await fsm::event(Event::buttonPressed);
+ *     }
+ * public:
+ *     explicit Blinker(BaseEventSource* button) : CoroutineState(button) { }
+ * };
+ *
+ * auto blinker = new Blinker(button);
+ * blinker->whenDone(idle);
+ * @endcode
+ */
+class CoroutineState : public State {
+    /**
+     * Action that starts, resumes and destroys the behavior with the state.
+     */
+    class Driver final : public Action {
+        CoroutineState& owner;     ///< State owning the behavior.
+        unsigned long waitStart{0};///< Time the current delay counts from.
+        fsm::Wait* lastWait{nullptr};///< Wait seen on the previous execution.
+
+    public:
+        explicit Driver(CoroutineState& state) : owner{state} { }
+
+        void arm() override;
+        void disarm() override { owner.behavior.reset(); }
+        void execute() override;
+        void action() override { }
+        bool getTimeUntilDue(unsigned long& time) const override;
+    };
+
+    Driver driver{*this};          ///< Drives the behavior from `FSM::run`.
+    BaseEventSource* events;       ///< Default source of `fsm::event` waits.
+    fsm::Behavior behavior;        ///< Behavior of the current visit.
+
+protected:
+    /**
+     * Defines the behavior run each time the state is entered.
+     *
+     * @return The coroutine.
+     */
+    virtual fsm::Behavior behave() = 0;
+
+public:
+    /**
+     * Constructs a coroutine state.
+     *
+     * @param eventSource Default source of `fsm::event` waits. Can be `nullptr`.
+     * @param timeout Optional state timeout in milliseconds.
+     */
+    explicit CoroutineState(BaseEventSource* eventSource = nullptr, unsigned long timeout = 0);
+
+    /**
+     * Checks whether the behavior of the current visit ran to its end.
+     *
+     * @return `true` if the behavior finished.
+     */
+    bool isDone() const { return behavior.isDone(); }
+
+    /**
+     * Adds a transition taken once the behavior finishes.
+     *
+     * @param next The next state.
+     * @return A pointer to this state for method chaining.
+     */
+    CoroutineState* whenDone(State* next);
+};
+
+#endif //FSM_COROUTINES
+
+#endif //COROUTINE_STATE_H
@@ -25,8 +25,12 @@
  *     ButtonSource::buttonPressed()
  * ));
  * @endcode
+ *
+ * @note The class is final, like every built-in transition, because states check
+ * it without a virtual call. A different matching rule (an event with a guard, for
+ * instance) is a custom `Transition` with `EVENT_TRANSITION` priority.
  */
-class EventTransition : public Transition {
+class EventTransition final : public Transition {
     const Event* expectedEvent; ///< The event that triggers the transition.
     BaseEventSource* eventSource; ///< Source generating the events.
 
@@ -40,14 +44,25 @@ public:
      * @param source Pointer to the event source.
      */
     explicit EventTransition(State* next, const Event* event, BaseEventSource* source)
-        : Transition(next), expectedEvent(event), eventSource(source) { }
+        : Transition(next, EVENT_TRANSITION, true), expectedEvent(event), eventSource(source) { }
+
+    /**
+     * Retrieves the event that triggers the transition.
+     *
+     * @return Pointer to the expected event, or `nullptr` if none.
+     */
+    const Event* getExpectedEvent() const { return expectedEvent; }
 
-    TransitionPriority getPriority() const override { return EVENT_TRANSITION; }
+    /**
+     * Retrieves the source polled for events.
+     *
+     * @return Pointer to the event source, or `nullptr` if none.
+     */
+    BaseEventSource* getEventSource() const { return eventSource; }
 
     bool isTriggered() override {
-        // If there is not an expected event, return true
         // Event will never be nullptr, it will always have a value or Event::none
-        // let's check the event
+        if (!eventSource) return false;
         Event *event = eventSource->getEvent();
         if (expectedEvent && event == expectedEvent) {
             setLastEvent(event);
@@ -8,6 +8,8 @@
 
 
 #include "State.h"
+#include "TransitionObserver.h"
+#include "events/EventQueue.h"
 
 #ifdef FSM_DEBUG
 inline void logStateTransition(State* from, State* to) {
@@ -39,8 +41,41 @@ class FSM {
     State* initialState;         ///< Pointer to the initial state of the FSM.
     State* currentState{nullptr};///< Pointer to the current state of the FSM.
     bool running{false};         ///< Indicates whether the FSM is currently running.
+    State** states{nullptr};     ///< Table of the states reachable from the initial state.
+    uint16_t totalStates{0};     ///< Number of entries in `states`.
+    TransitionObserver* observer{nullptr}; ///< Optional observer notified of state changes.
+    EventQueue* queue{nullptr};  ///< Optional mailbox of posted events.
+    uint8_t maxHops{1};          ///< Transitions `run` may take in one call.
+    unsigned long timerDeadline{0}; ///< Deadline of the current state's timer, in its unit.
+    bool timerArmed{false};      ///< Whether the current state's timer runs, as of `cacheDeadline`.
+    bool timerMicros{false};     ///< Whether `timerDeadline` is in microseconds.
+    unsigned long hopLimitHits{0}; ///< Runs that reached `maxHops` transitions through a cycle.
+    State** visited{nullptr};    ///< States entered by the current run, `maxHops + 1` entries when `maxHops` > 1.
+    bool matrixEnabled{false};   ///< Whether `build` precomputes the transition matrix.
+    uint16_t* matrix{nullptr};   ///< Target state index per (state index, column), or `State::NO_INDEX`.
+    uint16_t matrixColumns{0};   ///< Number of distinct events expected by this FSM's event transitions.
+    uint16_t* columnOf{nullptr}; ///< Matrix column per event ID from `firstEventId`, or `NO_COLUMN`.
+    uint16_t firstEventId{0};    ///< Lowest event ID covered by `columnOf`.
+    uint16_t totalEventIds{0};   ///< Number of entries in `columnOf`.
+
+    static constexpr uint16_t NO_COLUMN = 0xFFFF; ///< `columnOf` entry of an event no transition expects.
+
+    void buildMatrix();
+    void cacheDeadline();
+    void changeState(State* nextState, Event* event);
+
+    // Snapshot header: version in the high nibble, flags in the low nibble.
+    static constexpr uint8_t SNAPSHOT_VERSION = 1;
+    static constexpr uint8_t SNAPSHOT_RUNNING = 0x01;
+    static constexpr uint8_t SNAPSHOT_TIMER   = 0x02;
+    static constexpr uint8_t SNAPSHOT_STATE   = 0x04;
 
 public:
+    /**
+     * Largest encoding produced by `snapshot`: header, state index and remaining time.
+     */
+    static constexpr size_t SNAPSHOT_MAX_SIZE = 1 + 3 + (sizeof(unsigned long) * 8 + 6) / 7;
+
     /**
      * Constructs an FSM instance with an optional initial state.
      *
@@ -48,7 +83,52 @@ public:
      */
     explicit FSM(State* initState): initialState{initState} { }
 
-    ~FSM() = default;
+    ~FSM() {
+        delete[] states;
+        delete[] matrix;
+        delete[] columnOf;
+        delete[] visited;
+    }
+
+    /**
+     * Builds the state table by walking the transition graph from the initial state.
+     *
+     * States are stored in breadth-first order, so the same construction code always
+     * yields the same table, and each state receives its position as its dense index
+     * (`State::getIndex`). `start` builds the table; call `build` again if transitions
+     * are added or removed afterwards.
+     */
+    void build();
+
+    /**
+     * Enables the precomputed state x event transition matrix, built by `build`.
+     *
+     * The matrix maps each (state index, event) pair to the target of the first
+     * event transition of that state expecting that event, so `dispatch` finds it in
+     * two array lookups. It has one column per distinct event expected by this FSM,
+     * costing two bytes per state and such event, plus two bytes per event ID between
+     * the lowest and highest expected ID for the event-to-column table.
+     *
+     * @param enabled Whether to build the matrix.
+     * @return A pointer to this FSM for method chaining.
+     */
+    FSM* setTransitionMatrix(const bool enabled) {
+        matrixEnabled = enabled;
+        return this;
+    }
+
+    /**
+     * Delivers an event directly to the event transitions of the current state.
+     *
+     * Behavior:
+     * - Takes the first event transition of the current state expecting this event,
+     *   whatever its source, without polling any source or checking other transitions.
+     * - Uses the transition matrix when enabled, otherwise scans the transitions.
+     *
+     * @param event The event.
+     * @return `true` if the FSM changed state, `false` otherwise.
+     */
+    bool dispatch(Event* event);
 
     /**
      * Starts the FSM, transitioning to the initial state and invoking its `onEnter` method.
@@ -76,12 +156,120 @@ public:
      *
      * Behavior:
      * - If a triggered transition is detected, the FSM transitions to the corresponding state.
+     *   With `setMaxHops` above 1, it keeps following the transitions triggered in each new
+     *   state (immediate transitions, conditions already true) within the same call.
      * - If no transitions are triggered, invokes the `onUpdate` method of the current state.
      *
      * Preconditions:
      * - The FSM must be in a running state (started).
+     *
+     * @return The number of state changes made.
+     */
+    uint8_t run();
+
+    /**
+     * Sets how many transitions `run` may take in one call (run-to-completion).
+     *
+     * The default of 1 takes one transition per call. A larger bound lets a chain of
+     * immediate or already-true transitions complete in a single call; reaching the
+     * bound by going around a cycle is counted by `getHopLimitHits`. A bound above 1
+     * allocates a table of `hops + 1` state pointers to record the states entered.
+     *
+     * @param hops Maximum transitions per call, at least 1.
+     * @return A pointer to this FSM for method chaining.
+     */
+    FSM* setMaxHops(const uint8_t hops) {
+        maxHops = hops > 0 ? hops : 1;
+        delete[] visited;
+        visited = maxHops > 1 ? new State*[maxHops + 1] : nullptr;
+        return this;
+    }
+
+    /**
+     * Retrieves the maximum number of transitions per `run`.
+     *
+     * @return The bound set by `setMaxHops`.
+     */
+    uint8_t getMaxHops() const { return maxHops; }
+
+    /**
+     * Retrieves the number of runs that were cut short by a transition cycle.
+     *
+     * Only counted when the bound is above 1. A run counts when it takes `maxHops`
+     * transitions and one of them re-entered a state already visited in that run,
+     * including the state it started from. A chain of distinct states exactly as long
+     * as the bound is not counted, and neither is a cycle longer than the bound,
+     * which a larger bound brings into view.
+     *
+     * @return The number of runs that reached `maxHops` transitions through a cycle.
+     */
+    unsigned long getHopLimitHits() const { return hopLimitHits; }
+
+    /**
+     * Encodes the FSM's execution state into a few bytes.
+     *
+     * The snapshot holds the running flag, the index of the current state in the
+     * state table and the time left on its timer. It is only valid for an FSM built
+     * by the same construction code.
+     *
+     * @param buffer Destination buffer, `SNAPSHOT_MAX_SIZE` bytes are always enough.
+     * @param size Capacity of the buffer in bytes.
+     * @return The number of bytes written, or 0 if the buffer is too small.
+     */
+    size_t snapshot(uint8_t* buffer, size_t size) const;
+
+    /**
+     * Resumes the FSM from a snapshot.
+     *
+     * The current state is set directly, without replaying the transitions that led
+     * to it, and its timer resumes with the time that was left.
+     *
+     * @param buffer Snapshot produced by `snapshot`.
+     * @param size Length of the snapshot in bytes.
+     * @param reenter Whether to invoke the restored state's `onEnter` to re-establish its outputs.
+     * @return `true` if the snapshot was valid and applied, `false` otherwise.
+     */
+    bool restore(const uint8_t* buffer, size_t size, bool reenter = true);
+
+    /**
+     * Sets the observer notified after every state change.
+     *
+     * @param transitionObserver The observer, or `nullptr` to remove it.
+     * @return A pointer to this FSM for method chaining.
+     */
+    FSM* setObserver(TransitionObserver* transitionObserver) {
+        observer = transitionObserver;
+        return this;
+    }
+
+    /**
+     * Sets the queue receiving events posted to this FSM.
+     *
+     * Each `run` presents the next queued event to the transitions that use the
+     * queue as their event source.
+     *
+     * @param eventQueue The queue, or `nullptr` to remove it.
+     * @return A pointer to this FSM for method chaining.
      */
-    void run();
+    FSM* setQueue(EventQueue* eventQueue) {
+        queue = eventQueue;
+        return this;
+    }
+
+    /**
+     * Retrieves the queue of posted events.
+     *
+     * @return Pointer to the queue, or `nullptr` if none.
+     */
+    EventQueue* getQueue() const { return queue; }
+
+    /**
+     * Posts an event to this FSM's queue.
+     *
+     * @param event The event to deliver on a later `run`.
+     * @return `true` if queued, `false` if there is no queue or it is full.
+     */
+    bool post(Event* event) { return queue && queue->post(event); }
 
     /**
      * Checks whether the FSM is currently running.
@@ -96,6 +284,42 @@ public:
      * @return Pointer to the current state, or `nullptr` if not running.
      */
     const State* getCurrentState() const { return currentState; }
+
+    /**
+     * Retrieves the initial state of the FSM.
+     *
+     * @return Pointer to the initial state, or `nullptr` if none was configured.
+     */
+    State* getInitialState() const { return initialState; }
+
+    /**
+     * Retrieves the number of states found by the last `build`.
+     *
+     * @return The number of reachable states.
+     */
+    uint16_t getTotalStates() const { return totalStates; }
+
+    /**
+     * Retrieves a state from the state table.
+     *
+     * @param index Position of the state in the table.
+     * @return Pointer to the state, or `nullptr` if the index is out of range.
+     */
+    State* getState(const uint16_t index) const { return index < totalStates ? states[index] : nullptr; }
+
+    /**
+     * Finds the position of a state in the state table.
+     *
+     * Constant time for the states of this FSM, through their dense index.
+     *
+     * @param state The state to look for.
+     * @return The index of the state, or `-1` if it is not part of this FSM.
+     */
+    int indexOf(const State* state) const;
+
+    // Disallow copy and assignment.
+    FSM(const FSM&) = delete;
+    FSM& operator=(const FSM&) = delete;
 };
 
 #endif //FSM_H
@@ -0,0 +1,147 @@
+/**
+ * Static analysis of FSM transition graphs.
+ *
+ * Responsibilities:
+ * - Reports unreachable states, dead, shadowed and duplicate transitions, and immediate-transition cycles.
+ * - Optionally unlinks transitions that can never fire, so `run()` no longer evaluates them.
+ */
+
+#ifndef FSM_ANALYZER_H
+#define FSM_ANALYZER_H
+
+#include "FSM.h"
+#include "Transition.h"
+
+/**
+ * Kinds of problems reported by `FSMAnalyzer`.
+ */
+enum class AnalysisIssue : uint8_t {
+    UNREACHABLE_STATE,    ///< The state can never be entered.
+    SHADOWED_TRANSITION,  ///< An earlier transition always fires first, so this one never does.
+    DUPLICATE_TRANSITION, ///< Same trigger as an earlier transition of the same priority.
+    DEAD_TRANSITION,      ///< The transition can never trigger (e.g. a timeout on a state without timer).
+    IMMEDIATE_CYCLE       ///< States chained by immediate transitions loop forever.
+};
+
+/**
+ * Summary of an analysis pass.
+ */
+struct FSMAnalysis {
+    uint16_t reachableStates{0};      ///< States that can be entered from the initial state.
+    uint16_t unreachableStates{0};    ///< States that can never be entered.
+    uint16_t shadowedTransitions{0};  ///< Transitions hidden by an earlier one.
+    uint16_t duplicateTransitions{0}; ///< Transitions repeating an earlier trigger.
+    uint16_t deadTransitions{0};      ///< Transitions that can never trigger.
+    uint16_t immediateCycles{0};      ///< Loops made of immediate transitions.
+    uint16_t prunedTransitions{0};    ///< Transitions removed by `prune`.
+
+    /**
+     * Checks whether the analysis found no problems.
+     *
+     * @return `true` if nothing was reported, `false` otherwise.
+     */
+    bool isClean() const {
+        return unreachableStates == 0 && shadowedTransitions == 0 && duplicateTransitions == 0 &&
+               deadTransitions == 0 && immediateCycles == 0;
+    }
+};
+
+/**
+ * @brief Static analysis of an FSM's transition graph
+ *
+ * Inspects every state of an FSM and reports transitions that can never fire,
+ * states that can never be entered and loops of immediate transitions. Dead
+ * transitions still cost an evaluation on every `run()`, so `prune` can unlink
+ * them from their states.
+ *
+ * Rules, following the evaluation order of `State::checkTransitions`:
+ * - A `StateTimeoutTransition` on a state without timer is dead.
+ * - A `ConditionTransition` without condition, or an `EventTransition` without
+ *   expected event or source, is dead.
+ * - Only the first timeout check of a state can see the timer elapse, so any
+ *   `StateTimeoutTransition` after a timed `PriorityTransition` or another
+ *   `StateTimeoutTransition` is shadowed.
+ * - Only the first `ImmediateTransition` of a state can fire.
+ * - A second event transition with the same priority, event and source, or a
+ *   second condition transition with the same plain function, is a duplicate.
+ * - States only reachable through dead transitions are unreachable.
+ *
+ * Custom transitions (see `Transition::isBuiltIn`) are never flagged.
+ *
+ * Usage:
+ * @code
+ * State* all[] = { idle, running, done };
+ * FSMAnalyzer analyzer(fsm, [](AnalysisIssue issue, const State* state, const Transition* tr) {
+ *     Serial.println(state->getId());
+ * });
+ * analyzer.declareStates(all, 3);
+ * FSMAnalysis result = analyzer.prune();
+ * @endcode
+ */
+class FSMAnalyzer {
+public:
+    /**
+     * Callback invoked for every problem found.
+     *
+     * @param issue Kind of problem.
+     * @param state State where the problem was found.
+     * @param transition Transition involved, or `nullptr` for state issues.
+     */
+    typedef void (*IssueHandler)(AnalysisIssue issue, const State* state, const Transition* transition);
+
+private:
+    FSM* fsm;                              ///< FSM under analysis.
+    IssueHandler handler;                  ///< Optional callback for each problem.
+    State* const* declaredStates{nullptr}; ///< Every state the application created, if known.
+    uint16_t totalDeclared{0};             ///< Number of entries in `declaredStates`.
+
+    FSMAnalysis run(bool removeDead);
+    void report(FSMAnalysis& result, AnalysisIssue issue, const State* state, const Transition* transition) const;
+    static bool findIssue(const State* state, const Transition* transition, bool& timerTaken,
+                          bool& immediateTaken, AnalysisIssue& issue);
+    static bool sameTrigger(const Transition* a, const Transition* b);
+
+public:
+    /**
+     * Constructs an analyzer for an FSM.
+     *
+     * @param machine The FSM to analyze.
+     * @param onIssue Optional callback invoked for every problem found.
+     */
+    explicit FSMAnalyzer(FSM* machine, const IssueHandler onIssue = nullptr)
+        : fsm{machine}, handler{onIssue} { }
+
+    /**
+     * Declares every state the application created.
+     *
+     * Without this list only states made unreachable by dead transitions can be
+     * detected, since the FSM only knows the states it can reach.
+     *
+     * @param states Array of states.
+     * @param count Number of states in the array.
+     * @return A pointer to this analyzer for method chaining.
+     */
+    FSMAnalyzer* declareStates(State* const* states, const uint16_t count) {
+        declaredStates = states;
+        totalDeclared = count;
+        return this;
+    }
+
+    /**
+     * Reports the problems found without changing the FSM.
+     *
+     * @return The analysis summary.
+     */
+    FSMAnalysis analyze() { return run(false); }
+
+    /**
+     * Reports the problems found and unlinks dead, shadowed and duplicate transitions.
+     *
+     * Removed transitions are not deleted. The FSM's state table is rebuilt afterwards.
+     *
+     * @return The analysis summary, including the number of pruned transitions.
+     */
+    FSMAnalysis prune() { return run(true); }
+};
+
+#endif //FSM_ANALYZER_H
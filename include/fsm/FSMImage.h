@@ -0,0 +1,212 @@
+/**
+ * Versioned binary image of a state machine definition.
+ *
+ * Responsibilities:
+ * - Defines a compact layout for states, their timeouts and hooks, and their
+ *   transitions with kind, target, guard and event binding.
+ * - Reads an image in place, from RAM, a memory-mapped file or memory-mapped flash.
+ * - Writes images into a caller-provided buffer, for host tools and tests.
+ *
+ * Design Considerations:
+ * - Loading checks the header and the sizes only, so it takes constant time
+ *   whatever the size of the machine; `verify` walks the records when the image
+ *   comes from an untrusted place.
+ * - Records have a fixed size and fields are read byte by byte, little-endian, so
+ *   the image needs no alignment and no conversion on any target.
+ * - Guards, hooks, events and sources are stored as IDs, bound at run time to the
+ *   tables of an `ImageBindings`; the image holds no pointers.
+ *
+ * Layout (all integers little-endian):
+ * - Header, 16 bytes: magic "FSMI", version (u16), reserved (u16), state count (u32),
+ *   transition count (u32). State 0 is the initial state.
+ * - States, 16 bytes each: first transition (u32), timeout in ms (u32, 0 for none),
+ *   transition count (u16), enter, exit and update hook IDs (u16 each).
+ * - Transitions, 12 bytes each, grouped by state and sorted by kind: target state
+ *   (u32), kind (u8, a `TransitionPriority`), flags (u8, `TIMEOUT_FLAG`), guard ID,
+ *   event ID and source ID (u16 each).
+ * - Unused IDs are `NO_BINDING`.
+ * - Kinds follow the library's transition classes: a priority transition fires on
+ *   its event, if it has a source, or on the state's timeout, if flagged, like
+ *   `PriorityTransition`. Every kind also accepts an optional guard.
+ */
+
+#ifndef FSM_IMAGE_H
+#define FSM_IMAGE_H
+
+#include <Arduino.h>
+#include "Transition.h"
+
+/**
+ * @brief Read-only view of a binary FSM image
+ *
+ * Usage:
+ * @code
+ * FSMImage image;
+ * if (image.load(data, size) && image.verify()) {
+ *     ImageFSM fsm(image, bindings);
+ *     fsm.start();
+ * }
+ * @endcode
+ */
+class FSMImage {
+    const uint8_t* data{nullptr};  ///< First byte of the image.
+    uint32_t totalStates{0};       ///< Number of states.
+    uint32_t totalTransitions{0};  ///< Number of transitions.
+
+    static uint16_t read16(const uint8_t* bytes) {
+        return static_cast<uint16_t>(bytes[0] | (bytes[1] << 8));
+    }
+
+    static uint32_t read32(const uint8_t* bytes) {
+        return static_cast<uint32_t>(bytes[0]) | (static_cast<uint32_t>(bytes[1]) << 8)
+               | (static_cast<uint32_t>(bytes[2]) << 16) | (static_cast<uint32_t>(bytes[3]) << 24);
+    }
+
+    const uint8_t* state(const uint32_t index) const { return data + HEADER_SIZE + index * STATE_SIZE; }
+
+    const uint8_t* transition(const uint32_t index) const {
+        return data + HEADER_SIZE + totalStates * STATE_SIZE + index * TRANSITION_SIZE;
+    }
+
+public:
+    static constexpr uint16_t VERSION = 2;           ///< Version written and accepted.
+    static constexpr uint16_t NO_BINDING = 0xFFFF;   ///< ID of an absent guard, hook, event or source.
+    static constexpr size_t HEADER_SIZE = 16;        ///< Bytes of the header.
+    static constexpr size_t STATE_SIZE = 16;         ///< Bytes per state record.
+    static constexpr size_t TRANSITION_SIZE = 12;    ///< Bytes per transition record.
+    static constexpr uint8_t TIMEOUT_FLAG = 0x01;    ///< Priority transition also fired by the state's timeout.
+
+    /**
+     * Computes the size of an image.
+     *
+     * @param states Number of states.
+     * @param transitions Number of transitions.
+     * @return The size in bytes.
+     */
+    static constexpr size_t sizeFor(const uint32_t states, const uint32_t transitions) {
+        return HEADER_SIZE + states * STATE_SIZE + transitions * TRANSITION_SIZE;
+    }
+
+    /**
+     * Attaches the view to an image. The image is not copied and must outlive the view.
+     *
+     * @param bytes First byte of the image.
+     * @param size Size of the image in bytes.
+     * @return `true` if the header is valid and the records fit, `false` otherwise.
+     */
+    bool load(const uint8_t* bytes, size_t size);
+
+    /**
+     * Checks every record: targets and transition ranges in bounds, known kinds and
+     * flags, the bindings each kind requires, and transitions of each state sorted by kind.
+     *
+     * @return `true` if the image is consistent, `false` otherwise.
+     */
+    bool verify() const;
+
+    /**
+     * Retrieves the number of states.
+     *
+     * @return The state count, 0 if no image is loaded.
+     */
+    uint32_t getTotalStates() const { return totalStates; }
+
+    /**
+     * Retrieves the number of transitions.
+     *
+     * @return The transition count, 0 if no image is loaded.
+     */
+    uint32_t getTotalTransitions() const { return totalTransitions; }
+
+    // Record fields. `s` is a state index and `t` a transition index; neither is
+    // checked here (see `verify`).
+    uint32_t getFirstTransition(const uint32_t s) const { return read32(state(s)); }
+    uint32_t getTimeout(const uint32_t s) const { return read32(state(s) + 4); }
+    uint16_t getTransitionCount(const uint32_t s) const { return read16(state(s) + 8); }
+    uint16_t getEnterHook(const uint32_t s) const { return read16(state(s) + 10); }
+    uint16_t getExitHook(const uint32_t s) const { return read16(state(s) + 12); }
+    uint16_t getUpdateHook(const uint32_t s) const { return read16(state(s) + 14); }
+
+    uint32_t getTarget(const uint32_t t) const { return read32(transition(t)); }
+    TransitionPriority getKind(const uint32_t t) const { return static_cast<TransitionPriority>(transition(t)[4]); }
+    bool hasTimeout(const uint32_t t) const { return transition(t)[5] & TIMEOUT_FLAG; }
+    uint16_t getGuard(const uint32_t t) const { return read16(transition(t) + 6); }
+    uint16_t getEvent(const uint32_t t) const { return read16(transition(t) + 8); }
+    uint16_t getSource(const uint32_t t) const { return read16(transition(t) + 10); }
+};
+
+/**
+ * @brief Writes an FSM image into a caller-provided buffer
+ *
+ * States are added in index order; each `addTransition` belongs to the last state
+ * added and must come in `TransitionPriority` order.
+ *
+ * Usage:
+ * @code
+ * uint8_t buffer[FSMImage::sizeFor(2, 2)];
+ * FSMImageWriter writer(buffer, sizeof(buffer), 2, 2);
+ * writer.addState(1000);
+ * writer.addTransition(TIMEOUT_TRANSITION, 1);
+ * writer.addState(0, LED_ON);
+ * writer.addTransition(PRIORITY_TRANSITION, 0, FSMImage::NO_BINDING, BUTTON, BUTTON_SOURCE, true);
+ * const size_t size = writer.finish();
+ * @endcode
+ */
+class FSMImageWriter {
+    uint8_t* buffer;               ///< Destination buffer.
+    uint32_t totalStates;          ///< States declared in the header.
+    uint32_t totalTransitions;     ///< Transitions declared in the header.
+    uint32_t states{0};            ///< States written so far.
+    uint32_t transitions{0};       ///< Transitions written so far.
+    bool valid;                    ///< Cleared when the buffer is too small or a record is out of place.
+
+    static void write16(uint8_t* bytes, uint16_t value);
+    static void write32(uint8_t* bytes, uint32_t value);
+
+public:
+    /**
+     * Constructs a writer and writes the header.
+     *
+     * @param destination Buffer of at least `FSMImage::sizeFor(stateCount, transitionCount)` bytes.
+     * @param size Capacity of the buffer in bytes.
+     * @param stateCount Number of states the image will hold.
+     * @param transitionCount Number of transitions the image will hold.
+     */
+    FSMImageWriter(uint8_t* destination, size_t size, uint32_t stateCount, uint32_t transitionCount);
+
+    /**
+     * Appends a state.
+     *
+     * @param timeout Timeout in milliseconds, or 0 for none.
+     * @param enter ID of the enter hook.
+     * @param exit ID of the exit hook.
+     * @param update ID of the update hook.
+     * @return `true` if written, `false` if all declared states were written.
+     */
+    bool addState(uint32_t timeout = 0, uint16_t enter = FSMImage::NO_BINDING,
+                  uint16_t exit = FSMImage::NO_BINDING, uint16_t update = FSMImage::NO_BINDING);
+
+    /**
+     * Appends a transition to the last state added.
+     *
+     * @param kind Kind of the transition, which sets when it is checked.
+     * @param target Index of the next state.
+     * @param guard ID of the guard; required by condition transitions, optional otherwise.
+     * @param event ID of the expected event, for event and priority transitions.
+     * @param source ID of the event source, for event and priority transitions.
+     * @param withTimeout Whether the state's timeout also fires a priority transition.
+     * @return `true` if written, `false` if no state was added or all declared transitions were written.
+     */
+    bool addTransition(TransitionPriority kind, uint32_t target, uint16_t guard = FSMImage::NO_BINDING,
+                       uint16_t event = FSMImage::NO_BINDING, uint16_t source = FSMImage::NO_BINDING,
+                       bool withTimeout = false);
+
+    /**
+     * Completes the image.
+     *
+     * @return The size of the image, or 0 if records are missing or did not fit.
+     */
+    size_t finish() const;
+};
+
+#endif //FSM_IMAGE_H
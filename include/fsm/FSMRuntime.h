@@ -0,0 +1,161 @@
+/**
+ * Scheduler that only steps the FSMs that have something to do.
+ *
+ * Responsibilities:
+ * - Keeps a ready set of FSMs: those with a posted event, an explicit wake-up,
+ *   a state timer that expired, or a transition in their last step.
+ * - Keeps the pending deadlines (state timers and state-scoped actions) in a min-heap,
+ *   so finding the expired ones costs O(log n) per expiry instead of a check per FSM per loop.
+ * - Steps every FSM registered as polled, for states that read sources directly.
+ *
+ * Design Considerations:
+ * - An event-driven FSM must only depend on its queue, its state timers, the actions
+ *   of its states and explicit `wake` calls. Anything else (polled sources, guards on pins, `onUpdate` work)
+ *   requires registering it as polled.
+ * - All storage is allocated once, in the constructor.
+ * - Not interrupt-safe: interrupt handlers should set a flag that the main loop turns into `wake`.
+ */
+
+#ifndef FSM_RUNTIME_H
+#define FSM_RUNTIME_H
+
+#include "FSM.h"
+
+/**
+ * @brief Ready-set runtime for many FSMs
+ *
+ * Usage:
+ * @code
+ * FSMRuntime runtime(300);
+ * for (auto door : doors) {
+ *     door->setQueue(new EventQueue(4));
+ *     handles[i] = runtime.add(door);
+ * }
+ * runtime.start();
+ *
+ * void loop() {
+ *     if (commandArrived) runtime.post(handles[target], Event::serialReceived);
+ *     runtime.run();
+ * }
+ * @endcode
+ */
+class FSMRuntime {
+    static constexpr uint16_t NONE = 0xFFFF; ///< End of list / not in heap.
+
+    /**
+     * Scheduling data of one FSM.
+     */
+    struct Machine {
+        FSM* fsm;               ///< The FSM.
+        unsigned long deadline; ///< Expiry of the current state's timer or next action.
+        uint16_t heapIndex;     ///< Position in `heap`, or `NONE`.
+        uint16_t nextReady;     ///< Next entry of the ready list.
+        bool ready;             ///< Set while in the ready list.
+        bool polled;            ///< Stepped on every `run`.
+    };
+
+    Machine* machines;        ///< Registered FSMs, by handle.
+    uint16_t capacity;        ///< Maximum number of FSMs.
+    uint16_t total{0};        ///< Number of registered FSMs.
+    uint16_t* heap;           ///< Handles ordered by deadline.
+    uint16_t heapSize{0};     ///< Number of entries in `heap`.
+    uint16_t* polled;         ///< Handles of the polled FSMs.
+    uint16_t totalPolled{0};  ///< Number of entries in `polled`.
+    uint16_t readyHead{NONE}; ///< First handle of the ready list.
+    uint16_t readyTail{NONE}; ///< Last handle of the ready list.
+    unsigned long totalSteps{0}; ///< FSM steps since construction.
+
+    void markReady(uint16_t handle);
+    void step(uint16_t handle);
+    void schedule(uint16_t handle);
+    void heapRemove(uint16_t handle);
+    void heapUp(uint16_t index);
+    void heapDown(uint16_t index);
+    void heapPlace(uint16_t index, uint16_t handle);
+
+    /**
+     * Compares two times, tolerating the wrap-around of the clock.
+     */
+    static bool isBefore(const unsigned long a, const unsigned long b) {
+        return static_cast<long>(a - b) < 0;
+    }
+
+public:
+    /**
+     * Constructs a runtime.
+     *
+     * @param maxMachines Maximum number of FSMs.
+     */
+    explicit FSMRuntime(uint16_t maxMachines);
+
+    ~FSMRuntime();
+
+    /**
+     * Registers an FSM.
+     *
+     * @param fsm The FSM.
+     * @param isPolled Step the FSM on every `run`, for states that poll sources or do work in `onUpdate`.
+     * @return The handle of the FSM, or -1 if the runtime is full.
+     */
+    int add(FSM* fsm, bool isPolled = false);
+
+    /**
+     * Starts every registered FSM that is not running and marks all of them ready.
+     */
+    void start();
+
+    /**
+     * Posts an event to an FSM's queue and marks it ready.
+     *
+     * @param handle Handle returned by `add`.
+     * @param event The event to deliver.
+     * @return `true` if queued, `false` if the FSM has no queue or it is full.
+     */
+    bool post(uint16_t handle, Event* event);
+
+    /**
+     * Marks an FSM ready, e.g. after one of its sources signaled new input.
+     *
+     * @param handle Handle returned by `add`.
+     */
+    void wake(uint16_t handle);
+
+    /**
+     * Steps the polled FSMs, the FSMs whose deadline passed and the ready ones.
+     *
+     * FSMs that become ready during the pass are stepped on the next call.
+     *
+     * @return The number of FSM steps performed.
+     */
+    uint16_t run();
+
+    /**
+     * Retrieves the earliest pending state-timer deadline.
+     *
+     * Lets the application sleep until there is work, when nothing is ready.
+     *
+     * @param deadline Receives the deadline, in `Clock` time.
+     * @return `true` if a deadline is pending, `false` otherwise.
+     */
+    bool getNextDeadline(unsigned long& deadline) const;
+
+    /**
+     * Checks whether FSMs are waiting to be stepped.
+     *
+     * @return `true` if the ready list is not empty, `false` otherwise.
+     */
+    bool hasReady() const { return readyHead != NONE; }
+
+    /**
+     * Retrieves the number of FSM steps performed.
+     *
+     * @return The total number of `FSM::run` calls made by this runtime.
+     */
+    unsigned long getTotalSteps() const { return totalSteps; }
+
+    // Disallow copy and assignment.
+    FSMRuntime(const FSMRuntime&) = delete;
+    FSMRuntime& operator=(const FSMRuntime&) = delete;
+};
+
+#endif //FSM_RUNTIME_H
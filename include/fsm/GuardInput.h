@@ -0,0 +1,135 @@
+/**
+ * Inputs that condition guards can declare as dependencies.
+ *
+ * Responsibilities:
+ * - Counts the changes of a value, so a guard knows when its result may have changed.
+ * - Provides ready-made inputs for variables (`Signal`) and digital pins (`PinInput`).
+ *
+ * Design Considerations:
+ * - The change counter is a single byte, so it can be bumped from an interrupt
+ *   (`touch`) without locking on 8-bit boards.
+ * - A guard re-evaluates when any counter differs from the value it saw last,
+ *   so a missed change is only possible after exactly 256 changes between two checks.
+ */
+
+#ifndef GUARD_INPUT_H
+#define GUARD_INPUT_H
+
+#include <Arduino.h>
+
+/**
+ * @brief Base class for guard dependencies
+ *
+ * Custom inputs either call `touch` whenever their value changes, or override
+ * `refresh` to sample the value and call `touch` when it differs.
+ */
+class GuardInput {
+    volatile uint8_t version{0}; ///< Incremented on every change.
+
+public:
+    GuardInput() = default;
+
+    virtual ~GuardInput() = default;
+
+    /**
+     * Marks the input as changed. Safe to call from an interrupt handler.
+     */
+    void touch() { version = version + 1; }
+
+    /**
+     * Retrieves the change counter.
+     *
+     * @return The number of changes, modulo 256.
+     */
+    uint8_t getVersion() const { return version; }
+
+    /**
+     * Samples the underlying value. Called before the counter is compared.
+     *
+     * Inputs that are told about changes (see `touch`) keep the default, which does nothing.
+     */
+    virtual void refresh() { }
+};
+
+/**
+ * @brief Variable whose writes mark dependent guards dirty
+ *
+ * Usage:
+ * @code
+ * Signal<int> temperature;
+ * heating->addTransition((new ConditionTransition(idle, [] { return temperature > 22; }))
+ *     ->dependsOn(&temperature));
+ * temperature.set(readSensor()); // the guard runs again only if the value changed
+ * @endcode
+ *
+ * @tparam T Type of the value; must support `!=` and copying.
+ */
+template <typename T>
+class Signal final : public GuardInput {
+    T value; ///< Current value.
+
+public:
+    /**
+     * Constructs a signal.
+     *
+     * @param initial Initial value.
+     */
+    explicit Signal(const T& initial = T()) : value(initial) { }
+
+    /**
+     * Sets the value, marking the signal changed if it differs.
+     *
+     * @param newValue The new value.
+     */
+    void set(const T& newValue) {
+        if (value != newValue) {
+            value = newValue;
+            touch();
+        }
+    }
+
+    /**
+     * Retrieves the value.
+     *
+     * @return The current value.
+     */
+    const T& get() const { return value; }
+
+    operator const T&() const { return value; }
+};
+
+/**
+ * @brief Digital pin sampled before each guard check
+ *
+ * A `digitalRead` per check is much cheaper than guards that talk to a sensor,
+ * and the guard itself only runs when the level changed.
+ */
+class PinInput final : public GuardInput {
+    uint8_t pin;   ///< Pin number.
+    int level;     ///< Last level read.
+
+public:
+    /**
+     * Constructs a pin input. The pin mode must be configured by the application.
+     *
+     * @param inputPin Pin number.
+     */
+    explicit PinInput(const uint8_t inputPin) : pin{inputPin}, level{digitalRead(inputPin)} { }
+
+    void refresh() override {
+        const int current = digitalRead(pin);
+        if (current != level) {
+            level = current;
+            touch();
+        }
+    }
+
+    /**
+     * Retrieves the last level read.
+     *
+     * @return `HIGH` or `LOW`.
+     */
+    int getLevel() const { return level; }
+};
+
+#endif //GUARD_INPUT_H
@@ -0,0 +1,127 @@
+/**
+ * State machine executed directly from a binary image.
+ *
+ * Responsibilities:
+ * - Runs the machine described by an `FSMImage`, with the same transition order
+ *   as `FSM`: priority, condition, event, timeout, then immediate transitions.
+ * - Calls the guards, hooks, events and sources bound by ID in an `ImageBindings`.
+ *
+ * Design Considerations:
+ * - No state or transition object is created: the current state is an index into
+ *   the image, and each step reads the records of that state in place, so a
+ *   machine of any size starts in constant time.
+ * - A single timer serves the timeout of the current state.
+ * - Hooks receive the events `FSM` passes: the triggering event of event and
+ *   priority transitions, `Event::none` for the other kinds and for priority
+ *   transitions fired by the timeout, and `nullptr` on the entry made by `start`.
+ * - IDs outside the binding tables are treated as absent: a missing guard never
+ *   fires, a missing hook is not called.
+ */
+
+#ifndef IMAGE_FSM_H
+#define IMAGE_FSM_H
+
+#include "FSMImage.h"
+#include "Callable.h"
+#include "actions/AlarmTimer.h"
+#include "events/BaseEventSource.h"
+
+/**
+ * Tables binding the IDs used by an image to code and event objects.
+ *
+ * Every table is indexed by ID and owned by the application, typically as static arrays.
+ */
+struct ImageBindings {
+    typedef Callable<bool()> Guard;       ///< Condition of a transition.
+    typedef Callable<void(Event*)> Hook;  ///< Enter, exit or update hook; update hooks receive `nullptr`.
+
+    const Guard* guards{nullptr};         ///< Guards by ID.
+    uint16_t totalGuards{0};              ///< Number of guards.
+    const Hook* hooks{nullptr};           ///< Hooks by ID.
+    uint16_t totalHooks{0};               ///< Number of hooks.
+    Event* const* events{nullptr};        ///< Expected events by ID.
+    uint16_t totalEvents{0};              ///< Number of events.
+    BaseEventSource* const* sources{nullptr}; ///< Event sources by ID.
+    uint16_t totalSources{0};             ///< Number of sources.
+};
+
+/**
+ * @brief FSM interpreter over a binary image
+ *
+ * Usage:
+ * @code
+ * static const ImageBindings::Hook hooks[] = { [](Event*) { digitalWrite(LED, HIGH); } };
+ * ImageBindings bindings;
+ * bindings.hooks = hooks;
+ * bindings.totalHooks = 1;
+ *
+ * FSMImage image;
+ * image.load(data, size);
+ * ImageFSM fsm(image, bindings);
+ * fsm.start();
+ *
+ * void loop() {
+ *     fsm.run();
+ * }
+ * @endcode
+ */
+class ImageFSM {
+    const FSMImage& image;           ///< The machine definition.
+    const ImageBindings& bindings;   ///< Code and events bound to the image's IDs.
+    uint32_t currentState{0};        ///< Index of the current state.
+    bool running{false};             ///< Whether the machine is running.
+    AlarmTimer timer;                ///< Timer of the current state's timeout.
+
+    bool isTriggered(uint32_t transition, Event*& event);
+    bool receive(uint32_t transition, Event*& event);
+    bool checkGuard(uint16_t guard) const;
+    void callHook(uint16_t hook, Event* event) const;
+    void enter(uint32_t state, Event* event);
+
+public:
+    /**
+     * Constructs an interpreter. The image and the bindings must outlive it.
+     *
+     * @param definition A loaded image.
+     * @param table Bindings of the image's IDs.
+     */
+    ImageFSM(const FSMImage& definition, const ImageBindings& table) : image{definition}, bindings{table} { }
+
+    /**
+     * Enters state 0 and starts running.
+     */
+    void start();
+
+    /**
+     * Stops the machine, staying in the current state.
+     */
+    void stop() { running = false; }
+
+    /**
+     * Executes one update cycle: takes the first triggered transition of the
+     * current state, or calls its update hook if none is triggered.
+     *
+     * @return `true` if the machine changed state, `false` otherwise.
+     */
+    bool run();
+
+    /**
+     * Retrieves the current state.
+     *
+     * @return The index of the current state in the image.
+     */
+    uint32_t getCurrentState() const { return currentState; }
+
+    /**
+     * Checks whether the machine is running.
+     *
+     * @return `true` once started and until stopped.
+     */
+    bool isRunning() const { return running; }
+
+    // Disallow copy and assignment.
+    ImageFSM(const ImageFSM&) = delete;
+    ImageFSM& operator=(const ImageFSM&) = delete;
+};
+
+#endif //IMAGE_FSM_H
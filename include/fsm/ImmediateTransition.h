@@ -23,9 +23,7 @@ public:
      *
      * @param next Pointer to the next state.
      */
-    explicit ImmediateTransition(State* next): Transition(next) {  }
-
-    TransitionPriority getPriority() const override { return IMMEDIATE_TRANSITION; }
+    explicit ImmediateTransition(State* next): Transition(next, IMMEDIATE_TRANSITION, true) {  }
 
     bool isTriggered() override {
         return true;  // Always transitions
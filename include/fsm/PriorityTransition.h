@@ -29,7 +29,9 @@
  * ));
  * @endcode
  */
-class PriorityTransition final : public EventTransition {
+class PriorityTransition final : public Transition {
+    const Event* expectedEvent{nullptr};    ///< The event that triggers the transition, if any.
+    BaseEventSource* eventSource{nullptr};  ///< Source generating the events, if any.
     bool checkTimeout{true}; ///< Whether to check the state's timer for timeout.
 
 
@@ -39,7 +41,7 @@ public:
      *
      * @param next Pointer to the next state.
      */
-     explicit PriorityTransition(State* next): EventTransition(next, nullptr, nullptr) { }
+     explicit PriorityTransition(State* next): Transition(next, PRIORITY_TRANSITION, true) { }
 
     /**
      * Constructs a priority transition with event and timeout check.
@@ -50,13 +52,39 @@ public:
      * @param hasTimeout Whether to include timeout checks.
      */
     explicit PriorityTransition(State* next, const Event* event, BaseEventSource* source, const bool hasTimeout = false):
-         EventTransition(next, event, source), checkTimeout(hasTimeout) { }
+         Transition(next, PRIORITY_TRANSITION, true), expectedEvent(event), eventSource(source),
+         checkTimeout(hasTimeout) { }
 
-    TransitionPriority getPriority() const override { return PRIORITY_TRANSITION; }
+    /**
+     * Retrieves the event that triggers the transition.
+     *
+     * @return Pointer to the expected event, or `nullptr` if none.
+     */
+    const Event* getExpectedEvent() const { return expectedEvent; }
+
+    /**
+     * Retrieves the source polled for events.
+     *
+     * @return Pointer to the event source, or `nullptr` if none.
+     */
+    BaseEventSource* getEventSource() const { return eventSource; }
+
+    /**
+     * Checks whether the transition also fires on the owner's timeout.
+     *
+     * @return `true` if the state's timer is checked, `false` otherwise.
+     */
+    bool hasTimeout() const { return checkTimeout; }
 
     bool isTriggered() override {
-        // Checks event if specified
-        if (EventTransition::isTriggered()) { return true; }
+        // Checks event if specified, with the same rule as EventTransition
+        if (eventSource) {
+            Event* event = eventSource->getEvent();
+            if (expectedEvent && event == expectedEvent) {
+                setLastEvent(event);
+                return true;
+            }
+        }
 
         // Check timeout if enabled
         if (checkTimeout) {
@@ -0,0 +1,151 @@
+/**
+ * Compact byte encoding used by FSM and action snapshots.
+ *
+ * Responsibilities:
+ * - Writes and reads bytes and variable-length integers into caller-provided buffers.
+ *
+ * Design Considerations:
+ * - Unsigned values use 7 bits per byte (LEB128), so small values such as state
+ *   indices and remaining times below 128 ms take a single byte.
+ * - Signed values are zigzag-encoded first, so -1 also takes a single byte.
+ * - Neither class allocates memory; overflows and truncated input are reported, not thrown.
+ */
+
+#ifndef SNAPSHOT_CODEC_H
+#define SNAPSHOT_CODEC_H
+
+#include <Arduino.h>
+
+/**
+ * Writes snapshot data into a fixed-size buffer.
+ */
+class SnapshotWriter {
+    uint8_t* buffer; ///< Destination buffer.
+    size_t size;     ///< Capacity of the buffer in bytes.
+    size_t length{0};///< Bytes written so far.
+    bool overflow{false}; ///< Set when a write did not fit.
+
+public:
+    /**
+     * Constructs a writer over a buffer.
+     *
+     * @param buf Destination buffer.
+     * @param capacity Capacity of the buffer in bytes.
+     */
+    SnapshotWriter(uint8_t* buf, const size_t capacity) : buffer{buf}, size{capacity} { }
+
+    /**
+     * Writes a single byte.
+     *
+     * @param value The byte to write.
+     */
+    void writeByte(const uint8_t value) {
+        if (length < size) {
+            buffer[length++] = value;
+        } else {
+            overflow = true;
+        }
+    }
+
+    /**
+     * Writes an unsigned value using as few bytes as possible.
+     *
+     * @param value The value to write.
+     */
+    void writeVarint(unsigned long value) {
+        while (value >= 0x80) {
+            writeByte(static_cast<uint8_t>(value | 0x80));
+            value >>= 7;
+        }
+        writeByte(static_cast<uint8_t>(value));
+    }
+
+    /**
+     * Writes a signed value using as few bytes as possible.
+     *
+     * @param value The value to write.
+     */
+    void writeSigned(const long value) {
+        writeVarint((static_cast<unsigned long>(value) << 1) ^ static_cast<unsigned long>(value >> (sizeof(long) * 8 - 1)));
+    }
+
+    /**
+     * Retrieves the number of bytes written.
+     *
+     * @return The encoded length, or 0 if the buffer was too small.
+     */
+    size_t getLength() const { return overflow ? 0 : length; }
+};
+
+/**
+ * Reads snapshot data from a buffer.
+ */
+class SnapshotReader {
+    const uint8_t* buffer; ///< Source buffer.
+    size_t size;           ///< Number of bytes available.
+    size_t position{0};    ///< Bytes read so far.
+    bool truncated{false}; ///< Set when a read ran past the end of the buffer.
+
+public:
+    /**
+     * Constructs a reader over a buffer.
+     *
+     * @param buf Source buffer.
+     * @param length Number of bytes available.
+     */
+    SnapshotReader(const uint8_t* buf, const size_t length) : buffer{buf}, size{length} { }
+
+    /**
+     * Reads a single byte.
+     *
+     * @return The byte read, or 0 if the buffer is exhausted.
+     */
+    uint8_t readByte() {
+        if (position < size) {
+            return buffer[position++];
+        }
+        truncated = true;
+        return 0;
+    }
+
+    /**
+     * Reads an unsigned value written by `SnapshotWriter::writeVarint`.
+     *
+     * @return The value read.
+     */
+    unsigned long readVarint() {
+        unsigned long value = 0;
+        for (uint8_t shift = 0; shift < sizeof(unsigned long) * 8; shift += 7) {
+            const uint8_t byte = readByte();
+            value |= static_cast<unsigned long>(byte & 0x7F) << shift;
+            if (!(byte & 0x80)) break;
+        }
+        return value;
+    }
+
+    /**
+     * Reads a signed value written by `SnapshotWriter::writeSigned`.
+     *
+     * @return The value read.
+     */
+    long readSigned() {
+        const unsigned long value = readVarint();
+        return static_cast<long>(value >> 1) ^ -static_cast<long>(value & 1);
+    }
+
+    /**
+     * Checks whether every read so far was within the buffer.
+     *
+     * @return `true` if the input was long enough, `false` otherwise.
+     */
+    bool isValid() const { return !truncated; }
+
+    /**
+     * Retrieves the number of bytes consumed.
+     *
+     * @return The position of the next byte to read.
+     */
+    size_t getPosition() const { return position; }
+};
+
+#endif //SNAPSHOT_CODEC_H
@@ -7,6 +7,8 @@
 
 #include "events/Event.h"
 #include "actions/AlarmTimer.h"
+#include "actions/Action.h"
+#include "actions/ExecutionStats.h"
 
 /**
 * @brief Base class for finite state machine states
@@ -51,7 +53,8 @@ class Transition;
  *
  * Design Considerations:
  * - A state can have multiple transitions, evaluated in priority order.
- * - Transition management is facilitated using a linked list structure.
+ * - Transition management is facilitated using a linked list kept sorted by priority,
+ *   so checking the transitions is a single pass.
  *
  * Usage:
  * - Extend this class to create specific states with custom behavior.
@@ -72,22 +75,37 @@ class Transition;
  * @endcode
  */
 class State {
-    static int8_t _ids; ///< Counter to assign unique IDs to states.
-    int id{++_ids};     ///< Unique ID of the state.
-    int8_t totalTransitions{0}; ///< Total number of transitions for this state.
+    static uint16_t _ids; ///< Counter to assign unique IDs to states.
+    uint16_t id{_ids++};  ///< Unique ID of the state.
+    uint16_t index{NO_INDEX}; ///< Position in the state table of the FSM that built it.
+    uint16_t totalTransitions{0}; ///< Total number of transitions for this state.
+    bool timeoutOnly{true}; ///< Whether every transition is a built-in timeout transition.
     Transition* triggeredTransition{nullptr}; ///< Transition triggered during evaluation.
     AlarmTimer* stateTimer{nullptr}; ///< Timer for state timeout functionality.
 
     Transition* firstTransition{nullptr}; ///< Pointer to the first transition.
     Transition* lastTransition{nullptr};  ///< Pointer to the last transition.
 
+    Action* firstAction{nullptr};         ///< First action scoped to this state.
+    Action* lastAction{nullptr};          ///< Last action scoped to this state.
+    unsigned long actionsDue{0};          ///< Earliest time a timed action needs to execute.
+    bool actionsPending{false};           ///< Whether a timed action will execute again.
+    bool actionsWaiting{false};           ///< Whether an action waits on something other than time.
+    StateProfile* profile{nullptr};       ///< Optional execution-time statistics of the hooks.
+
+    void updateActionsDue(unsigned long now);
+    bool isTriggered(Transition* transition) const;
+
 public:
+    static constexpr uint16_t NO_INDEX = 0xFFFF; ///< Index of a state outside any state table.
+
     /**
      * Constructs a state with an optional timeout duration.
      *
-     * @param timeout Timeout duration in milliseconds. Defaults to 0 (no timeout).
+     * @param timeout Timeout duration in `unit`. Defaults to 0 (no timeout).
+     * @param unit Resolution of the timeout. Defaults to milliseconds.
      */
-    explicit State(unsigned long timeout = 0);
+    explicit State(unsigned long timeout = 0, TimeUnit unit = TimeUnit::MILLISECONDS);
 
     /**
      * Virtual destructor for proper cleanup of derived classes.
@@ -102,6 +120,24 @@ public:
      */
     State* addTransition(Transition* transition);
 
+    /**
+     * Removes a transition from the state.
+     *
+     * The transition is only unlinked; it is not deleted.
+     *
+     * @param transition Pointer to the transition to remove.
+     * @return `true` if the transition belonged to this state, `false` otherwise.
+     */
+    bool removeTransition(Transition* transition);
+
+    /**
+     * Retrieves the first transition of the state, in evaluation order: by priority,
+     * then in insertion order.
+     *
+     * @return Pointer to the first transition, or `nullptr` if there are none.
+     */
+    Transition* getFirstTransition() const { return firstTransition; }
+
     /**
      * Checks transitions for a triggered condition.
      *
@@ -114,7 +150,17 @@ public:
      *
      * @return The total number of transitions.
      */
-    int8_t getTotalTransitions() const { return totalTransitions; }
+    uint16_t getTotalTransitions() const { return totalTransitions; }
+
+    /**
+     * Checks whether the state can only be left through its timer: all its
+     * transitions, if any, are `StateTimeoutTransition`s.
+     *
+     * The FSM skips the transition check of such a state until its timer is due.
+     *
+     * @return `true` if only the timer can trigger a transition, `false` otherwise.
+     */
+    bool isTimeoutOnly() const { return timeoutOnly; }
 
     /**
      * Retrieves the last triggered transition.
@@ -123,6 +169,76 @@ public:
      */
     Transition* getTriggeredTransition() const { return triggeredTransition; }
 
+    /**
+     * Adds an action that runs only while this state is active.
+     *
+     * The FSM arms the action when the state is entered, executes it from `run` when
+     * it is due, and disarms it when the state is exited. The action must not also
+     * be added to a `Scheduler`.
+     *
+     * @param action Pointer to the action to add.
+     * @return A pointer to this state for method chaining.
+     */
+    State* addAction(Action* action);
+
+    /**
+     * Retrieves the first action scoped to this state.
+     *
+     * @return Pointer to the first action, or `nullptr` if there are none.
+     */
+    Action* getFirstAction() const { return firstAction; }
+
+    /**
+     * Arms the state's actions. Called by the FSM after `onEnter`.
+     */
+    void armActions();
+
+    /**
+     * Disarms the state's actions. Called by the FSM before `onExit`.
+     */
+    void disarmActions();
+
+    /**
+     * Executes the state's actions if the earliest of them is due. Called by the FSM
+     * on every `run`; between deadlines it costs a single time comparison. While an
+     * action waits on something other than time (`Action::NOT_DUE`), the actions
+     * execute on every call.
+     */
+    void runActions();
+
+    /**
+     * Executes the state's actions if the earliest of them is due at a given time.
+     *
+     * @param now Current `Clock` time in milliseconds, read once by the caller.
+     */
+    void runActions(unsigned long now);
+
+    /**
+     * Retrieves the time until the next action of the state is due.
+     *
+     * @param time Receives the time in milliseconds; 0 means due now.
+     * @return `true` if an action waiting on time will execute again, `false` otherwise.
+     */
+    bool getActionTime(unsigned long& time) const;
+
+    /**
+     * Attaches execution-time statistics of the state's hooks, filled by the FSM.
+     *
+     * @param hookProfile The statistics, or `nullptr` to stop measuring.
+     * @return A pointer to this state for method chaining.
+     */
+    State* setProfile(StateProfile* hookProfile) {
+        profile = hookProfile;
+        return this;
+    }
+
+    /**
+     * Retrieves the execution-time statistics of the state's hooks.
+     *
+     * @return Pointer to the statistics, or `nullptr` if the hooks are not measured.
+     */
+    StateProfile* getProfile() const { return profile; }
+
     /**
      * Checks whether the state's timer has elapsed.
      *
@@ -130,6 +246,28 @@ public:
      */
     bool isTimerElapsed() const;
 
+    /**
+     * Checks whether the state's timer would elapse now, without consuming it.
+     *
+     * @return `true` if the state has a running timer past its timeout, `false` otherwise.
+     */
+    bool isTimerDue() const { return stateTimer && stateTimer->isDue(); }
+
+    /**
+     * Retrieves the deadline of the state's timer.
+     *
+     * @return The `Clock` time of the timeout, in the unit of the timeout; meaningful
+     *         only while the timer runs (`isStateTimerRunning`).
+     */
+    unsigned long getTimerDeadline() const { return stateTimer ? stateTimer->getNextTrigger() : 0; }
+
+    /**
+     * Checks whether the state was created with a timeout.
+     *
+     * @return `true` if the state owns a timer, `false` otherwise.
+     */
+    bool hasTimer() const { return stateTimer != nullptr; }
+
     /**
      * Starts the state's timer.
      */
@@ -140,6 +278,53 @@ public:
      */
     void stopStateTimer() const;
 
+    /**
+     * Checks whether the state's timer is running.
+     *
+     * @return `true` if the state has a running timer, `false` otherwise.
+     */
+    bool isStateTimerRunning() const { return stateTimer && stateTimer->isRunning(); }
+
+    /**
+     * Retrieves the time left on the state's timer.
+     *
+     * @return The remaining time in the unit of the timeout, or 0 if there is no running timer.
+     */
+    unsigned long getRemainingTime() const { return stateTimer ? stateTimer->remaining() : 0; }
+
+    /**
+     * Retrieves the resolution of the state's timeout.
+     *
+     * @return The unit of the timeout and of `getRemainingTime`.
+     */
+    TimeUnit getTimeUnit() const { return stateTimer ? stateTimer->getUnit() : TimeUnit::MILLISECONDS; }
+
+    /**
+     * Restarts the state's timer with a custom time until the timeout.
+     *
+     * @param remainingTime Time until the timeout, in the unit of the timeout.
+     */
+    void resumeStateTimer(unsigned long remainingTime) const;
+
+    /**
+     * Invokes `onEnter`, timing it if the state has a profile. Used by the FSM.
+     *
+     * @param event Pointer to the event triggering the transition. Can be `nullptr`.
+     */
+    void enter(Event* event) const;
+
+    /**
+     * Invokes `onExit`, timing it if the state has a profile. Used by the FSM.
+     *
+     * @param event Pointer to the event triggering the transition. Can be `nullptr`.
+     */
+    void exit(Event* event) const;
+
+    /**
+     * Invokes `onUpdate`, timing it if the state has a profile. Used by the FSM.
+     */
+    void update() const;
+
     /**
      * Hook invoked when entering the state.
      *
@@ -167,6 +352,22 @@ public:
      */
     int getId() const { return id; }
 
+    /**
+     * Retrieves the dense index of the state in its FSM's state table.
+     *
+     * Indices run from 0 to `FSM::getTotalStates() - 1` and are assigned by `FSM::build`.
+     *
+     * @return The index, or `NO_INDEX` if no FSM has built a table with this state.
+     */
+    uint16_t getIndex() const { return index; }
+
+    /**
+     * Sets the dense index of the state. Used by `FSM::build`.
+     *
+     * @param position Position of the state in the state table.
+     */
+    void setIndex(const uint16_t position) { index = position; }
+
     /**
      * Equality operator to compare two states.
      *
@@ -31,9 +31,7 @@ public:
      * @param next Pointer to the next state.
      */
     explicit StateTimeoutTransition(State* next)
-        : Transition(next) {  }
-
-    TransitionPriority getPriority() const override { return TIMEOUT_TRANSITION; }
+        : Transition(next, TIMEOUT_TRANSITION, true) {  }
 
     bool isTriggered() override {
         // The owner always exists
@@ -28,11 +28,22 @@ enum TransitionPriority : uint8_t {
  *
  * Usage:
  * @code
- * Transition* trans = new EventTransition(nextState);
+ * Transition* trans = new EventTransition(nextState, Event::buttonPressed, button);
  * currentState.addTransition(trans);
+ *
+ * // Custom transition: checked through a virtual call, after the built-in
+ * // transitions of higher priority
+ * class ThresholdTransition final : public Transition {
+ * public:
+ *     explicit ThresholdTransition(State* next) : Transition(next, CONDITION_TRANSITION) { }
+ *     bool isTriggered() override { return analogRead(A0) > 512; }
+ * };
  * @endcode
  *
  * @note Transitions are owned by their state and shouldn't be deleted manually
+ * @note Custom transitions no longer override `getPriority()`, which is not virtual;
+ *       they pass their priority to the constructor, as above, instead of calling
+ *       `Transition(State*)`.
  */
 
 class Transition {
@@ -40,15 +51,36 @@ class Transition {
     State* ownerState{nullptr}; ///< Pointer to the owning state.
     Event* lastEvent{Event::none}; ///< The last event that triggered this transition.
     Transition* nextTransition{nullptr}; ///< Pointer to the next transition in the linked list.
+    TransitionPriority priority; ///< When the transition is checked; with `builtIn`, also its class.
+    bool builtIn{false}; ///< Whether the transition is one of the library's own transition classes.
+
+    // The state casts a built-in transition to the class its priority names, so only
+    // those classes may set the flag.
+    friend class PriorityTransition;
+    friend class ConditionTransition;
+    friend class EventTransition;
+    friend class StateTimeoutTransition;
+    friend class ImmediateTransition;
 
+    /**
+     * Constructs a transition of one of the library's own classes.
+     *
+     * @param next Pointer to the next state.
+     * @param order Priority of the class.
+     * @param isBuiltIn `true` for the built-in transition classes, which the state evaluates
+     *                  without a virtual call and analysis tools may inspect.
+     */
+    Transition(State* next, const TransitionPriority order, const bool isBuiltIn)
+        : nextState(next), priority(order), builtIn(isBuiltIn) { }
 
 protected:
     /**
-     * Constructs a transition with a specified next state.
+     * Constructs a custom transition.
      *
      * @param next Pointer to the next state.
+     * @param order When the transition is checked relative to the state's other transitions.
      */
-    explicit Transition(State* next): nextState(next) { }
+    Transition(State* next, const TransitionPriority order): nextState(next), priority(order) { }
 
 public:
     virtual ~Transition() = default;
@@ -56,6 +88,9 @@ public:
     /**
      * Checks if the transition is triggered.
      *
+     * The state calls this for custom transitions only; built-in ones are checked
+     * through their class directly.
+     *
      * @return `true` if the transition is triggered, `false` otherwise.
      */
     virtual bool isTriggered()  = 0;
@@ -65,7 +100,7 @@ public:
      *
      * @return The transition priority as a `TransitionPriority` value.
      */
-    virtual TransitionPriority getPriority() const = 0;
+    TransitionPriority getPriority() const { return priority; }
 
     /**
      * Sets the owning state of the transition.
@@ -86,6 +121,16 @@ public:
      */
     Event *getLastEvent() const { return lastEvent; }
     void setLastEvent(Event *event) { lastEvent = event; }
+
+    /**
+     * Checks whether the transition is one of the library's own transition classes.
+     *
+     * The priority of a built-in transition identifies its class; custom subclasses are opaque.
+     * The built-in classes are final, so the flag always identifies the exact class.
+     *
+     * @return `true` for built-in transitions, `false` for custom ones.
+     */
+    bool isBuiltIn() const { return builtIn; }
 };
 
 #endif //TRANSITION_H
\ No newline at end of file
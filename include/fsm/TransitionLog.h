@@ -0,0 +1,228 @@
+/**
+ * Durable write-ahead log of FSM state changes for POSIX hosts.
+ *
+ * Responsibilities:
+ * - Appends a record for every state change of the attached FSMs.
+ * - Commits records in groups, with one `fdatasync` per batch.
+ * - Periodically compacts the log into a snapshot file.
+ * - Rebuilds every attached FSM from the snapshot and the log after a crash.
+ *
+ * Design Considerations:
+ * - Only available where POSIX file I/O exists (Linux gateways, host builds).
+ * - A record is the FSM's own `snapshot()` plus its instance ID and a sequence
+ *   number, so recovery resumes each timer with the time left when it was logged.
+ */
+
+#ifndef TRANSITION_LOG_H
+#define TRANSITION_LOG_H
+
+#if defined(__unix__) || defined(__APPLE__)
+
+#include <sys/types.h>
+#include "FSM.h"
+#include "TransitionObserver.h"
+
+/**
+ * @brief Append-only transition log with group commit
+ *
+ * Record layout: marker byte, sequence number (varint), instance ID (varint),
+ * snapshot length, snapshot bytes, CRC-8 of all previous bytes. A torn record
+ * at the end of the log fails its CRC and is discarded by `recover()`.
+ *
+ * Snapshot file layout: magic "BFSS", last sequence number covered (varint),
+ * number of entries (varint), then per entry the instance ID (varint), the
+ * snapshot length and bytes, and a CRC-8 of the whole file. It is written to a
+ * temporary file and renamed, so a crash leaves either the old or the new one.
+ *
+ * Usage:
+ * @code
+ * TransitionLog wal("door.log", "door.snap");
+ * wal.setGroupCommit(64, 10)->setCompaction(10000);
+ * wal.attach(doorFsm, 1)->attach(lightFsm, 2);
+ * wal.open();
+ * wal.recover();
+ * if (!doorFsm->isRunning()) doorFsm->start();
+ *
+ * void loop() {
+ *     doorFsm->run();
+ *     wal.poll(); // commits a partial batch once it is old enough
+ * }
+ * @endcode
+ *
+ * @note Records are durable only once committed. A crash loses at most the last
+ * uncommitted batch: `maxRecords` records or `maxDelay` milliseconds of changes.
+ */
+class TransitionLog {
+    class Binding;
+
+    const char* logPath;          ///< Path of the append-only log.
+    const char* snapshotPath;     ///< Path of the compacted snapshot.
+    char* tempPath{nullptr};      ///< `snapshotPath` with a ".tmp" suffix.
+    int logFd{-1};                ///< Descriptor of the open log.
+
+    Binding** bindings{nullptr};  ///< FSMs attached to this log.
+    uint16_t totalBindings{0};    ///< Number of entries in `bindings`.
+    uint16_t bindingCapacity{0};  ///< Capacity of `bindings`.
+
+    uint8_t* buffer{nullptr};     ///< Records waiting for the next commit.
+    uint16_t capacity{0};         ///< Records `buffer` can hold.
+    size_t used{0};               ///< Bytes used in `buffer`.
+    uint16_t pending{0};          ///< Records in `buffer`.
+    off_t committedSize{0};       ///< Length of the log up to the last durable record.
+    bool tornTail{false};         ///< Whether bytes past `committedSize` remain to be cut before appending.
+    unsigned long firstPending{0};///< Time the oldest pending record was appended.
+    uint32_t nextSequence{1};     ///< Sequence number of the next record.
+
+    uint16_t maxRecords{64};      ///< Records per group commit.
+    uint16_t nextMaxRecords{64};  ///< Records per group commit from the next `open`.
+    unsigned long maxDelay{10};   ///< Longest time a record waits for its commit, in milliseconds.
+    unsigned long compactEvery{0};///< Records between compactions, 0 to compact only on request.
+    unsigned long sinceCompaction{0}; ///< Records appended since the last compaction.
+
+    unsigned long totalRecords{0};///< Records committed since `open`.
+    unsigned long totalCommits{0};///< Group commits (syncs) since `open`.
+    unsigned long totalErrors{0}; ///< Failed commits, compactions and tail cuts since `open`.
+    unsigned long droppedRecords{0}; ///< Records lost because the buffer was full of failed ones.
+
+    void append(uint16_t instance, const FSM* fsm);
+    Binding* find(uint16_t instance) const;
+    bool writeAll(int fd, const uint8_t* data, size_t length);
+    bool cutTail();
+    static uint8_t crc8(const uint8_t* data, size_t length);
+
+public:
+    /**
+     * Largest encoded record: marker, sequence, instance, length, snapshot and CRC.
+     */
+    static constexpr size_t RECORD_MAX_SIZE = 1 + 5 + 3 + 1 + FSM::SNAPSHOT_MAX_SIZE + 1;
+
+    /**
+     * Constructs a transition log.
+     *
+     * @param log Path of the append-only log file.
+     * @param snapshot Path of the snapshot file written by compaction.
+     */
+    TransitionLog(const char* log, const char* snapshot);
+
+    /**
+     * Commits pending records and closes the log.
+     */
+    ~TransitionLog();
+
+    /**
+     * Configures group commit. The delay applies at once; the record count, which
+     * sizes the commit buffer, takes effect on the next `open`.
+     *
+     * @param records Records per commit; 1 syncs every state change.
+     * @param delay Longest time in milliseconds a record may wait, enforced by `poll`.
+     * @return A pointer to this log for method chaining.
+     */
+    TransitionLog* setGroupCommit(uint16_t records, unsigned long delay);
+
+    /**
+     * Configures automatic compaction.
+     *
+     * @param records Records between compactions, or 0 to compact only when `compact` is called.
+     * @return A pointer to this log for method chaining.
+     */
+    TransitionLog* setCompaction(const unsigned long records) {
+        compactEvery = records;
+        return this;
+    }
+
+    /**
+     * Attaches an FSM. Its state changes are logged from then on.
+     *
+     * The FSM's observer is replaced by the log.
+     *
+     * @param fsm The FSM to log.
+     * @param instance ID identifying the FSM across restarts.
+     * @return A pointer to this log for method chaining.
+     */
+    TransitionLog* attach(FSM* fsm, uint16_t instance);
+
+    /**
+     * Opens (or creates) the log file.
+     *
+     * @return `true` on success, `false` if the file could not be opened.
+     */
+    bool open();
+
+    /**
+     * Rebuilds the attached FSMs from the snapshot file and the log.
+     *
+     * Each FSM is restored once, from its latest record, and its `onEnter` runs
+     * again. FSMs with no record are left untouched, so they can be started normally.
+     * A torn record at the end of the log is cut off.
+     *
+     * @return The number of FSMs restored.
+     */
+    uint16_t recover();
+
+    /**
+     * Commits a partial batch once its oldest record waited `maxDelay` milliseconds.
+     *
+     * Call from the main loop.
+     */
+    void poll();
+
+    /**
+     * Writes and syncs all pending records.
+     *
+     * On an I/O error the log is cut back to its last durable record and the batch
+     * is kept, so the next commit retries it.
+     *
+     * @return `true` on success, `false` on an I/O error.
+     */
+    bool commit();
+
+    /**
+     * Writes a snapshot of every attached FSM and empties the log.
+     *
+     * @return `true` on success, `false` on an I/O error.
+     */
+    bool compact();
+
+    /**
+     * Commits pending records and closes the log file.
+     */
+    void close();
+
+    /**
+     * Retrieves the number of records committed since `open`.
+     *
+     * @return The number of durable records.
+     */
+    unsigned long getTotalRecords() const { return totalRecords; }
+
+    /**
+     * Retrieves the number of group commits since `open`.
+     *
+     * @return The number of syncs issued for the log.
+     */
+    unsigned long getTotalCommits() const { return totalCommits; }
+
+    /**
+     * Retrieves the number of failed commits, compactions and cuts of a torn tail
+     * since `open`, including those triggered from state changes.
+     *
+     * @return The number of I/O errors; 0 while every record reached the disk.
+     */
+    unsigned long getTotalErrors() const { return totalErrors; }
+
+    /**
+     * Retrieves the number of records dropped since `open` because the commit
+     * buffer was full of records that could not be written.
+     *
+     * @return The number of lost records.
+     */
+    unsigned long getDroppedRecords() const { return droppedRecords; }
+
+    // Disallow copy and assignment.
+    TransitionLog(const TransitionLog&) = delete;
+    TransitionLog& operator=(const TransitionLog&) = delete;
+};
+
+#endif // POSIX
+
+#endif //TRANSITION_LOG_H
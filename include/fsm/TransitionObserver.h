@@ -0,0 +1,36 @@
+/**
+ * Observer interface for FSM state changes.
+ *
+ * Responsibilities:
+ * - Lets logging, persistence and diagnostics follow every state change of an FSM.
+ *
+ * Design Considerations:
+ * - An FSM holds at most one observer; it is called synchronously from `start()` and `run()`.
+ */
+
+#ifndef TRANSITION_OBSERVER_H
+#define TRANSITION_OBSERVER_H
+
+class FSM;
+class State;
+class Event;
+
+class TransitionObserver {
+public:
+    /**
+     * Virtual destructor for proper cleanup of derived classes.
+     */
+    virtual ~TransitionObserver() = default;
+
+    /**
+     * Invoked after the FSM entered a new state.
+     *
+     * @param fsm The FSM that changed state.
+     * @param from The previous state, or `nullptr` when the FSM was started.
+     * @param to The new current state.
+     * @param event The event that triggered the transition. Can be `nullptr`.
+     */
+    virtual void onTransition(FSM* fsm, const State* from, const State* to, const Event* event) = 0;
+};
+
+#endif //TRANSITION_OBSERVER_H
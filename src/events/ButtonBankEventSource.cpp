@@ -0,0 +1,105 @@
+/**
+ * Implements the ButtonBankEventSource class: sampling and vertical-counter debouncing.
+ */
+
+#include "events/ButtonBankEventSource.h"
+#include "actions/Clock.h"
+
+namespace {
+    /**
+     * Computes the mask of the lines in use.
+     *
+     * @param count Number of lines.
+     * @return Bits 0 to `count - 1` set, all of them from 32 lines on.
+     */
+    uint32_t linesMask(const uint8_t count) {
+        return count < 32 ? static_cast<uint32_t>((1UL << count) - 1) : 0xFFFFFFFFUL;
+    }
+}
+
+/**
+ * Constructs a bank sampled by a port-reading function.
+ *
+ * @param portReader Returns the raw level of every line.
+ * @param count Number of lines, at most 32.
+ * @param activeLowMask Lines that read LOW when pressed.
+ * @param interval Time between samples in milliseconds.
+ */
+ButtonBankEventSource::ButtonBankEventSource(const PortReader portReader, const uint8_t count,
+                                             const uint32_t activeLowMask, const unsigned long interval)
+    : reader{portReader}, pins{nullptr}, totalPins{0}, lines{linesMask(count)},
+      activeLow{activeLowMask & linesMask(count)}, sampleInterval{interval}, lastSample{Clock::now()} { }
+
+/**
+ * Constructs a bank sampled from a list of pins.
+ *
+ * @param inputPins Pin of each line.
+ * @param count Number of pins, at most 32.
+ * @param activeLowMask Lines that read LOW when pressed.
+ * @param interval Time between samples in milliseconds.
+ */
+ButtonBankEventSource::ButtonBankEventSource(const uint8_t* inputPins, const uint8_t count,
+                                             const uint32_t activeLowMask, const unsigned long interval)
+    : reader{nullptr}, pins{inputPins}, totalPins{count < 32 ? count : uint8_t{32}}, lines{linesMask(count)},
+      activeLow{activeLowMask & linesMask(count)}, sampleInterval{interval}, lastSample{Clock::now()} { }
+
+/**
+ * Reads the raw level of every line.
+ *
+ * @return Bitmask of the lines reading HIGH.
+ */
+uint32_t ButtonBankEventSource::read() const {
+    if (reader) return reader();
+    uint32_t raw = 0;
+    for (uint8_t line = 0; line < totalPins; line++) {
+        if (digitalRead(pins[line]) == HIGH) {
+            raw |= 1UL << line;
+        }
+    }
+    return raw;
+}
+
+/**
+ * Debounces one raw sample of every line.
+ *
+ * Each line has a two-bit counter spread over `count1:count0`. It is cleared while
+ * the line reads its debounced state, and counts samples at the other level
+ * otherwise; when it wraps after four of them, the line toggles. Lines not in use
+ * never differ from their state, so they keep a cleared counter and never toggle.
+ *
+ * @param raw Raw level of every line.
+ */
+void ButtonBankEventSource::sample(const uint32_t raw) {
+    const uint32_t changed = ((raw & lines) ^ activeLow) ^ state;
+    count1 = (count1 ^ count0) & changed;
+    count0 = ~count0 & changed;
+    const uint32_t toggled = changed & ~(count0 | count1);
+    state ^= toggled;
+    pressedEdges |= toggled & state;
+    releasedEdges |= toggled & ~state;
+}
+
+/**
+ * Samples the bank when due and returns the next pending edge.
+ *
+ * @return `buttonPressed`, `buttonReleased` or `Event::none`.
+ */
+Event* ButtonBankEventSource::getEvent() {
+    const unsigned long now = Clock::now();
+    if (now - lastSample >= sampleInterval) {
+        lastSample = now;
+        sample(read());
+    }
+
+    const bool press = pressedEdges != 0;
+    uint32_t& edges = press ? pressedEdges : releasedEdges;
+    if (edges == 0) return Event::none;
+
+    uint8_t line = 0;
+    while (!(edges & (1UL << line))) {
+        line++;
+    }
+    edges &= ~(1UL << line);
+    const uint8_t value = pins ? pins[line] : line;
+    return press ? Event::buttonPressed->setByteValue(value) : Event::buttonReleased->setByteValue(value);
+}
@@ -12,6 +12,8 @@
 #include "events/Event.h"
 
 // Static member initializations.
+uint16_t Event::_ids = 0;
+
 /**
  * Represents no event. Used as a default placeholder.
  */
@@ -47,6 +49,11 @@ Event* Event::serialReceived = new Event(EventType::EVENT_SERIAL_RECEIVED);
  */
 Event* Event::serialSent = new Event(EventType::EVENT_SERIAL_SENT);
 
+/**
+ * Represents a complete frame received on a serial port.
+ */
+Event* Event::frameReceived = new Event(EventType::EVENT_FRAME_RECEIVED);
+
 /**
  * Constructs an event with a specified type.
  *
@@ -162,6 +169,15 @@ EventType Event::getEventType() const {
     return type;
 }
 
+/**
+ * Retrieves the type of the value carried by the event.
+ *
+ * @return The value type, `VALUE_NONE` if no value was set.
+ */
+ValueType Event::getValueType() const {
+    return valueType;
+}
+
 /**
  * Compares the current event with another event for equality.
  *
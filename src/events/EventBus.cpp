@@ -0,0 +1,165 @@
+/**
+ * Implements the EventBus class: source polling, batching and topic fan-out.
+ */
+
+#include "events/EventBus.h"
+
+/**
+ * Constructs an event bus.
+ *
+ * @param sourceCapacity Maximum number of sources.
+ * @param subscriptionCapacity Maximum number of subscriptions.
+ * @param batchCapacity Events collected before a fan-out.
+ */
+EventBus::EventBus(const uint8_t sourceCapacity, const uint16_t subscriptionCapacity, const uint8_t batchCapacity)
+    : sources{new Source[sourceCapacity]}, maxSources{sourceCapacity},
+      subscriptions{new Subscription[subscriptionCapacity]}, maxSubscriptions{subscriptionCapacity},
+      batch{new Pending[batchCapacity > 0 ? batchCapacity : 1]}, batchSize{batchCapacity > 0 ? batchCapacity : uint8_t{1}} { }
+
+EventBus::~EventBus() {
+    delete[] sources;
+    delete[] subscriptions;
+    delete[] batch;
+}
+
+/**
+ * Registers a source polled by `poll`.
+ *
+ * @param source The source.
+ * @param id Topic ID of its events.
+ * @return `true` if registered, `false` if the bus is full.
+ */
+bool EventBus::addSource(BaseEventSource* source, const uint16_t id) {
+    if (totalSources >= maxSources) return false;
+    sources[totalSources++] = { source, id };
+    return true;
+}
+
+/**
+ * Subscribes an FSM to a topic.
+ *
+ * @param fsm The subscriber.
+ * @param type Event type of the topic.
+ * @param id Topic ID, or `ANY_ID`.
+ * @return `true` if subscribed, `false` if the bus is full.
+ */
+bool EventBus::subscribe(FSM* fsm, const EventType type, const uint16_t id) {
+    return insert({ type, id, fsm, nullptr, 0 });
+}
+
+/**
+ * Subscribes an FSM managed by a runtime.
+ *
+ * @param runtime The runtime.
+ * @param handle Handle of the FSM in the runtime.
+ * @param type Event type of the topic.
+ * @param id Topic ID, or `ANY_ID`.
+ * @return `true` if subscribed, `false` if the bus is full.
+ */
+bool EventBus::subscribe(FSMRuntime* runtime, const uint16_t handle, const EventType type, const uint16_t id) {
+    return insert({ type, id, nullptr, runtime, handle });
+}
+
+/**
+ * Inserts a subscription, keeping the array sorted by topic and, within a topic,
+ * in subscription order.
+ *
+ * @param subscription The subscription.
+ * @return `true` if inserted, `false` if the array is full.
+ */
+bool EventBus::insert(const Subscription& subscription) {
+    if (totalSubscriptions >= maxSubscriptions) return false;
+    uint16_t index = totalSubscriptions;
+    while (index > 0 && isBefore(subscription.type, subscription.id,
+                                 subscriptions[index - 1].type, subscriptions[index - 1].id)) {
+        subscriptions[index] = subscriptions[index - 1];
+        index--;
+    }
+    subscriptions[index] = subscription;
+    totalSubscriptions++;
+    return true;
+}
+
+/**
+ * Finds the first subscription whose topic is not before the given one.
+ *
+ * @param type Event type.
+ * @param id Topic ID.
+ * @return Index of the subscription, or `totalSubscriptions` if none.
+ */
+uint16_t EventBus::lowerBound(const EventType type, const uint16_t id) const {
+    uint16_t low = 0;
+    uint16_t high = totalSubscriptions;
+    while (low < high) {
+        const uint16_t middle = low + (high - low) / 2;
+        if (isBefore(subscriptions[middle].type, subscriptions[middle].id, type, id)) {
+            low = middle + 1;
+        } else {
+            high = middle;
+        }
+    }
+    return low;
+}
+
+/**
+ * Publishes an event from application code.
+ *
+ * @param event The event, with its current value.
+ * @param id Topic ID.
+ */
+void EventBus::publish(Event* event, const uint16_t id) {
+    if (batched >= batchSize) {
+        flush();
+    }
+    batch[batched].event.capture(event);
+    batch[batched].id = id;
+    batched++;
+}
+
+/**
+ * Polls every source once and fans out the collected events.
+ */
+void EventBus::poll() {
+    for (uint8_t i = 0; i < totalSources; i++) {
+        Event* event = sources[i].source->getEvent();
+        if (event != Event::none) {
+            publish(event, sources[i].id);
+        }
+    }
+    flush();
+}
+
+/**
+ * Delivers every batched event, in publication order.
+ */
+void EventBus::flush() {
+    for (uint8_t i = 0; i < batched; i++) {
+        deliver(batch[i].event, batch[i].id);
+        if (batch[i].id != ANY_ID) {
+            deliver(batch[i].event, ANY_ID);
+        }
+    }
+    batched = 0;
+}
+
+/**
+ * Posts an event to the subscribers of one topic.
+ *
+ * @param event The event and its value.
+ * @param id Topic ID of the subscriptions to serve.
+ */
+void EventBus::deliver(const QueuedEvent& event, const uint16_t id) {
+    const EventType type = event.event->getEventType();
+    Event* posted = event.apply();
+    for (uint16_t i = lowerBound(type, id);
+         i < totalSubscriptions && subscriptions[i].type == type && subscriptions[i].id == id; i++) {
+        const Subscription& subscription = subscriptions[i];
+        const bool ok = subscription.runtime ? subscription.runtime->post(subscription.handle, posted)
+                                             : subscription.fsm->post(posted);
+        if (ok) {
+            delivered++;
+        } else {
+            dropped++;
+        }
+    }
+}
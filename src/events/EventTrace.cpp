@@ -0,0 +1,211 @@
+/**
+ * Implements the EventCatalog, EventRecorder and EventPlayer classes.
+ */
+
+#include "events/EventTrace.h"
+
+namespace {
+    constexpr uint8_t TRACE_MAGIC[4] = { 'B', 'F', 'E', 'T' }; ///< First bytes of every trace.
+    constexpr size_t RECORD_MAX_SIZE = 5 + 5 + 1 + 5;          ///< Largest encoded record.
+}
+
+/**
+ * Constructs a catalog holding the built-in events.
+ */
+EventCatalog::EventCatalog() {
+    events[totalEvents++] = Event::none;
+    events[totalEvents++] = Event::globalTimeout;
+    events[totalEvents++] = Event::localTimeout;
+    events[totalEvents++] = Event::buttonPressed;
+    events[totalEvents++] = Event::buttonReleased;
+    events[totalEvents++] = Event::serialReceived;
+    events[totalEvents++] = Event::serialSent;
+    events[totalEvents++] = Event::frameReceived;
+}
+
+/**
+ * Finds the index of an event.
+ *
+ * @param event The event to look up.
+ * @return Its index, or -1 if it is not in the catalog.
+ */
+int EventCatalog::indexOf(const Event* event) const {
+    for (uint8_t i = 0; i < totalEvents; i++) {
+        if (events[i] == event) return i;
+    }
+    return -1;
+}
+
+/**
+ * Adds a custom event.
+ *
+ * @param event The event to add.
+ * @return `true` if added, `false` if the catalog is full.
+ */
+bool EventCatalog::addEvent(Event* event) {
+    if (totalEvents >= MAX_EVENTS) return false;
+    events[totalEvents++] = event;
+    return true;
+}
+
+/**
+ * Writes the trace header and starts timing records from now.
+ */
+void EventRecorder::begin() {
+    out.write(TRACE_MAGIC, sizeof(TRACE_MAGIC));
+    out.write(TRACE_VERSION);
+    lastTime = Clock::now();
+    totalRecords = 0;
+    recording = true;
+}
+
+/**
+ * Appends an event to the trace.
+ *
+ * @param channel Number of the source that returned the event.
+ * @param event The event returned.
+ */
+void EventRecorder::record(const uint8_t channel, const Event* event) {
+    const int index = indexOf(event);
+    if (!recording || index < 0) return;
+
+    const unsigned long now = Clock::now();
+    uint8_t buffer[RECORD_MAX_SIZE];
+    SnapshotWriter writer(buffer, sizeof(buffer));
+    writer.writeVarint(now - lastTime);
+    writer.writeVarint(channel);
+    const ValueType valueType = event->getValueType();
+    writer.writeByte(static_cast<uint8_t>(index << 2 | valueType));
+    switch (valueType) {
+        case VALUE_BYTE:
+            writer.writeByte(event->getByteValue());
+            break;
+        case VALUE_INT:
+            writer.writeSigned(event->getIntValue());
+            break;
+        case VALUE_FLOAT: {
+            const float value = event->getFloatValue();
+            uint8_t bytes[sizeof(float)];
+            memcpy(bytes, &value, sizeof(float));
+            for (const uint8_t byte : bytes) {
+                writer.writeByte(byte);
+            }
+            break;
+        }
+        default:
+            break;
+    }
+    out.write(buffer, writer.getLength());
+    lastTime = now;
+    totalRecords++;
+}
+
+/**
+ * Validates the header, switches `Clock` to virtual time and decodes the first record.
+ *
+ * @param start Virtual time at which the trace starts.
+ * @return `true` if the trace header is valid, `false` otherwise.
+ */
+bool EventPlayer::begin(const unsigned long start) {
+    for (const uint8_t byte : TRACE_MAGIC) {
+        if (reader.readByte() != byte) valid = false;
+    }
+    if (reader.readByte() != TRACE_VERSION || !reader.isValid()) valid = false;
+    if (!valid) return false;
+
+    Clock::useVirtual(start);
+    nextTime = start;
+    totalRecords = 0;
+    decodeNext();
+    return true;
+}
+
+/**
+ * Decodes the next record, or clears `pending` at the end of the trace.
+ */
+void EventPlayer::decodeNext() {
+    pending = false;
+    SnapshotReader probe = reader;
+    probe.readByte();
+    if (!probe.isValid()) return; // end of trace
+
+    nextTime += reader.readVarint();
+    nextChannel = reader.readVarint();
+    const uint8_t tag = reader.readByte();
+    nextIndex = tag >> 2;
+    nextValueType = tag & 0x03;
+    switch (nextValueType) {
+        case VALUE_BYTE:
+            nextInt = reader.readByte();
+            break;
+        case VALUE_INT:
+            nextInt = reader.readSigned();
+            break;
+        case VALUE_FLOAT: {
+            uint8_t bytes[sizeof(float)];
+            for (uint8_t& byte : bytes) {
+                byte = reader.readByte();
+            }
+            memcpy(&nextFloat, bytes, sizeof(float));
+            break;
+        }
+        default:
+            break;
+    }
+    if (!reader.isValid() || nextIndex >= totalEvents) {
+        valid = false;
+        return;
+    }
+    pending = true;
+}
+
+/**
+ * Retrieves the pending event of a channel once its time has come.
+ *
+ * @param channel Number of the requesting source.
+ * @return The event, with its recorded value, or `Event::none`.
+ */
+Event* EventPlayer::take(const uint8_t channel) {
+    if (!pending || nextChannel != channel || static_cast<long>(Clock::now() - nextTime) < 0) {
+        return Event::none;
+    }
+
+    Event* event = events[nextIndex];
+    switch (nextValueType) {
+        case VALUE_BYTE:
+            event->setByteValue(static_cast<uint8_t>(nextInt));
+            break;
+        case VALUE_INT:
+            event->setIntValue(static_cast<int>(nextInt));
+            break;
+        case VALUE_FLOAT:
+            event->setFloatValue(nextFloat);
+            break;
+        default:
+            break;
+    }
+    delivered = true;
+    totalRecords++;
+    decodeNext();
+    return event;
+}
+
+/**
+ * Moves virtual time forward by one millisecond, unless more events are due now.
+ *
+ * Behavior:
+ * - If an event was delivered since the last call and the next one is also due,
+ *   time stands still so the sources can be polled again at the same instant.
+ * - Otherwise time advances, even if a due event was not requested by its source.
+ *
+ * @return `true` while records remain, `false` once the trace is exhausted.
+ */
+bool EventPlayer::step() {
+    if (!pending) return false;
+    const bool again = delivered && static_cast<long>(Clock::now() - nextTime) >= 0;
+    delivered = false;
+    if (!again) {
+        Clock::advance(1);
+    }
+    return true;
+}
@@ -0,0 +1,183 @@
+/**
+ * Implements the FramedSerialEventSource class: bulk drain, framing and in-place decoding.
+ */
+
+#include "events/FramedSerialEventSource.h"
+
+namespace {
+    constexpr uint8_t SLIP_END = 0xC0;     ///< SLIP frame terminator.
+    constexpr uint8_t SLIP_ESC = 0xDB;     ///< SLIP escape byte.
+    constexpr uint8_t SLIP_ESC_END = 0xDC; ///< Escaped `SLIP_END`.
+    constexpr uint8_t SLIP_ESC_ESC = 0xDD; ///< Escaped `SLIP_ESC`.
+}
+
+/**
+ * Constructs a framed serial source.
+ *
+ * @param mode Framing of the byte stream.
+ * @param bufferSize Buffer size; must hold the longest encoded frame.
+ * @param stream Port to read.
+ */
+FramedSerialEventSource::FramedSerialEventSource(const Framing mode, const size_t bufferSize, Stream& stream)
+    : port{stream}, framing{mode}, buffer{new uint8_t[bufferSize]}, capacity{bufferSize} { }
+
+/**
+ * Drains the port and returns the next complete frame, if any.
+ *
+ * @return `Event::frameReceived` carrying the payload length, or `Event::none`.
+ */
+Event* FramedSerialEventSource::getEvent() {
+    drain();
+    if (nextFrame()) {
+        frames++;
+        return Event::frameReceived->setIntValue(static_cast<int>(payloadLength));
+    }
+    return Event::none;
+}
+
+/**
+ * Reads every available byte that fits, compacting the buffer first if needed.
+ */
+void FramedSerialEventSource::drain() {
+    const int available = port.available();
+    if (available <= 0) return;
+
+    if (start > 0 && static_cast<size_t>(available) > capacity - end) {
+        memmove(buffer, buffer + start, end - start);
+        end -= start;
+        scan -= start;
+        start = 0;
+    }
+    const size_t space = capacity - end;
+    const size_t wanted = static_cast<size_t>(available) < space ? available : space;
+    if (wanted > 0) {
+        end += port.readBytes(buffer + end, wanted);
+    }
+}
+
+/**
+ * Extracts the next complete, valid frame from the buffer.
+ *
+ * Behavior:
+ * - Skips empty frames and counts malformed ones as errors.
+ * - Discards the buffer when it is full without a complete frame, then the rest of
+ *   that frame up to its terminator.
+ *
+ * @return `true` if `payload` now holds a frame, `false` otherwise.
+ */
+bool FramedSerialEventSource::nextFrame() {
+    while (start < end) {
+        if (framing == Framing::LENGTH_PREFIXED) {
+            const size_t length = buffer[start];
+            if (length + 1 > capacity) {
+                // Cannot ever fit: drop the length byte and resynchronize
+                errors++;
+                start++;
+                scan = start;
+                continue;
+            }
+            if (end - start < length + 1) break;
+            payload = buffer + start + 1;
+            payloadLength = length;
+            start += length + 1;
+            scan = start;
+            if (length > 0) return true;
+            continue;
+        }
+
+        const uint8_t terminator = framing == Framing::DELIMITED ? delimiter
+                                   : framing == Framing::COBS    ? 0x00
+                                                                 : SLIP_END;
+        const uint8_t* found = static_cast<const uint8_t*>(memchr(buffer + scan, terminator, end - scan));
+        if (!found) {
+            scan = end;
+            break;
+        }
+
+        const size_t frameEnd = found - buffer;
+        payload = buffer + start;
+        payloadLength = frameEnd - start;
+        start = frameEnd + 1;
+        scan = start;
+        if (resynchronizing) {
+            // Tail of a frame that overflowed the buffer
+            resynchronizing = false;
+            continue;
+        }
+        if (payloadLength == 0) continue;
+
+        bool valid = true;
+        if (framing == Framing::COBS) {
+            valid = decodeCobs(payload, payloadLength);
+        } else if (framing == Framing::SLIP) {
+            valid = decodeSlip(payload, payloadLength);
+        }
+        if (!valid) {
+            errors++;
+            continue;
+        }
+        if (payloadLength > 0) return true;
+    }
+
+    if (start == end) {
+        start = end = scan = 0;
+    } else if (start == 0 && end == capacity) {
+        overflows++;
+        resynchronizing = framing != Framing::LENGTH_PREFIXED;
+        start = end = scan = 0;
+    }
+    payload = nullptr;
+    payloadLength = 0;
+    return false;
+}
+
+/**
+ * Decodes a COBS frame (without its 0x00 terminator) in place.
+ *
+ * @param data Encoded bytes, overwritten with the payload.
+ * @param length Encoded length on input, payload length on output.
+ * @return `true` if the frame was well formed, `false` otherwise.
+ */
+bool FramedSerialEventSource::decodeCobs(uint8_t* data, size_t& length) {
+    size_t read = 0;
+    size_t write = 0;
+    while (read < length) {
+        const uint8_t code = data[read++];
+        if (code == 0 || read + code - 1 > length) return false;
+        for (uint8_t i = 1; i < code; i++) {
+            data[write++] = data[read++];
+        }
+        if (code < 0xFF && read < length) {
+            data[write++] = 0x00;
+        }
+    }
+    length = write;
+    return true;
+}
+
+/**
+ * Decodes a SLIP frame (without its END terminator) in place.
+ *
+ * @param data Encoded bytes, overwritten with the payload.
+ * @param length Encoded length on input, payload length on output.
+ * @return `true` if the frame was well formed, `false` otherwise.
+ */
+bool FramedSerialEventSource::decodeSlip(uint8_t* data, size_t& length) {
+    size_t write = 0;
+    for (size_t read = 0; read < length; read++) {
+        uint8_t byte = data[read];
+        if (byte == SLIP_ESC) {
+            if (++read >= length) return false;
+            if (data[read] == SLIP_ESC_END) {
+                byte = SLIP_END;
+            } else if (data[read] == SLIP_ESC_ESC) {
+                byte = SLIP_ESC;
+            } else {
+                return false;
+            }
+        }
+        data[write++] = byte;
+    }
+    length = write;
+    return true;
+}
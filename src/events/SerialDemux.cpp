@@ -0,0 +1,216 @@
+/**
+ * Implements the SerialDemux and SerialChannel classes: draining, routing and buffering.
+ */
+
+#include "events/SerialDemux.h"
+
+/**
+ * Constructs a channel.
+ *
+ * @param owner Demultiplexer feeding the channel.
+ * @param bufferSize Size of the ring buffer.
+ */
+SerialChannel::SerialChannel(SerialDemux& owner, const uint8_t bufferSize)
+    : demux{owner}, buffer{new uint8_t[bufferSize > 0 ? bufferSize : 1]}, capacity{bufferSize > 0 ? bufferSize : uint8_t{1}} { }
+
+/**
+ * Appends a routed byte, dropping it if the buffer is full.
+ *
+ * @param byte The byte.
+ */
+void SerialChannel::push(const uint8_t byte) {
+    if (count >= capacity) {
+        dropped++;
+        return;
+    }
+    buffer[(head + count) % capacity] = byte;
+    count++;
+}
+
+/**
+ * Retrieves the number of buffered bytes, draining the port first if empty.
+ *
+ * @return The number of bytes that can be read.
+ */
+int SerialChannel::available() {
+    if (count == 0) {
+        demux.poll();
+    }
+    return count;
+}
+
+/**
+ * Reads the oldest buffered byte.
+ *
+ * @return The byte, or -1 if none is available.
+ */
+int SerialChannel::read() {
+    if (available() == 0) return -1;
+    const uint8_t byte = buffer[head];
+    head = (head + 1) % capacity;
+    count--;
+    return byte;
+}
+
+/**
+ * Returns the oldest buffered byte without consuming it.
+ *
+ * @return The byte, or -1 if none is available.
+ */
+int SerialChannel::peek() {
+    return available() > 0 ? buffer[head] : -1;
+}
+
+/**
+ * Writes a byte to the shared port.
+ *
+ * @param byte The byte.
+ * @return The number of bytes written.
+ */
+size_t SerialChannel::write(const uint8_t byte) {
+    return demux.getPort().write(byte);
+}
+
+/**
+ * Constructs a demultiplexer.
+ *
+ * @param maxChannels Maximum number of routed channels.
+ * @param stream Port to drain.
+ * @param frameTerminator Byte that ends a prefixed frame.
+ */
+SerialDemux::SerialDemux(const uint8_t maxChannels, Stream& stream, const uint8_t frameTerminator)
+    : port{stream}, terminator{frameTerminator}, routes{new Route[maxChannels]}, maxRoutes{maxChannels} { }
+
+SerialDemux::~SerialDemux() {
+    for (uint8_t i = 0; i < totalRoutes; i++) {
+        delete routes[i].channel;
+    }
+    delete[] routes;
+    delete fallback;
+}
+
+/**
+ * Adds a channel receiving every byte found in a character set.
+ *
+ * @param characters The character set.
+ * @param bufferSize Channel buffer size.
+ * @return The channel, or `nullptr` if the demultiplexer is full.
+ */
+SerialChannel* SerialDemux::addChannel(const char* characters, const uint8_t bufferSize) {
+    return add({ RouteKind::CHARACTERS, 0, 0, characters, nullptr }, bufferSize);
+}
+
+/**
+ * Adds a channel receiving every byte in a range.
+ *
+ * @param first Lowest byte value.
+ * @param last Highest byte value.
+ * @param bufferSize Channel buffer size.
+ * @return The channel, or `nullptr` if the demultiplexer is full.
+ */
+SerialChannel* SerialDemux::addChannel(const uint8_t first, const uint8_t last, const uint8_t bufferSize) {
+    return add({ RouteKind::RANGE, first, last, nullptr, nullptr }, bufferSize);
+}
+
+/**
+ * Adds a channel receiving frames that start with a prefix byte.
+ *
+ * @param prefix Frame header byte.
+ * @param bufferSize Channel buffer size.
+ * @return The channel, or `nullptr` if the demultiplexer is full.
+ */
+SerialChannel* SerialDemux::addPrefixedChannel(const uint8_t prefix, const uint8_t bufferSize) {
+    return add({ RouteKind::PREFIX, prefix, prefix, nullptr, nullptr }, bufferSize);
+}
+
+/**
+ * Sets up the channel receiving every byte no rule matched.
+ *
+ * @param bufferSize Channel buffer size.
+ * @return The channel.
+ */
+SerialChannel* SerialDemux::addDefaultChannel(const uint8_t bufferSize) {
+    if (!fallback) {
+        fallback = new SerialChannel(*this, bufferSize);
+    }
+    return fallback;
+}
+
+/**
+ * Stores a routing rule with a new channel.
+ *
+ * @param route The rule, without its channel.
+ * @param bufferSize Channel buffer size.
+ * @return The channel, or `nullptr` if the demultiplexer is full.
+ */
+SerialChannel* SerialDemux::add(const Route& route, const uint8_t bufferSize) {
+    if (totalRoutes >= maxRoutes) return nullptr;
+    routes[totalRoutes] = route;
+    routes[totalRoutes].channel = new SerialChannel(*this, bufferSize);
+    return routes[totalRoutes++].channel;
+}
+
+/**
+ * Drains every available byte of the port into the channels.
+ */
+void SerialDemux::poll() {
+    uint8_t chunk[16];
+    int available;
+    while ((available = port.available()) > 0) {
+        const size_t wanted = available < static_cast<int>(sizeof(chunk)) ? available : sizeof(chunk);
+        const size_t received = port.readBytes(chunk, wanted);
+        if (received == 0) break;
+        for (size_t i = 0; i < received; i++) {
+            route(chunk[i]);
+        }
+    }
+}
+
+/**
+ * Delivers one byte to its channel.
+ *
+ * Behavior:
+ * - Inside a prefixed frame, every byte up to the terminator goes to the frame's channel.
+ * - Otherwise the first matching rule wins; unmatched bytes go to the default channel.
+ *
+ * @param byte The byte.
+ */
+void SerialDemux::route(const uint8_t byte) {
+    if (frame) {
+        frame->push(byte);
+        if (byte == terminator) {
+            frame = nullptr;
+        }
+        return;
+    }
+
+    for (uint8_t i = 0; i < totalRoutes; i++) {
+        const Route& rule = routes[i];
+        switch (rule.kind) {
+            case RouteKind::CHARACTERS:
+                if (byte != 0 && strchr(rule.characters, byte)) {
+                    rule.channel->push(byte);
+                    return;
+                }
+                break;
+            case RouteKind::RANGE:
+                if (byte >= rule.first && byte <= rule.last) {
+                    rule.channel->push(byte);
+                    return;
+                }
+                break;
+            case RouteKind::PREFIX:
+                if (byte == rule.first) {
+                    frame = rule.channel;
+                    return;
+                }
+                break;
+        }
+    }
+
+    if (fallback) {
+        fallback->push(byte);
+    } else {
+        unrouted++;
+    }
+}
@@ -0,0 +1,183 @@
+/**
+ * Implements the coroutine frame pool and the driving of CoroutineState behaviors.
+ */
+
+#include "fsm/CoroutineState.h"
+
+#ifdef FSM_COROUTINES
+
+#include "fsm/ConditionTransition.h"
+#include "actions/Clock.h"
+
+namespace {
+    /**
+     * Storage of the frame pool.
+     */
+    struct Frames {
+        alignas(alignof(max_align_t)) uint8_t storage[FSM_COROUTINE_FRAMES][FSM_COROUTINE_FRAME_SIZE];
+        bool used[FSM_COROUTINE_FRAMES];
+        unsigned long failures;
+    };
+
+    Frames& frames() {
+        static Frames pool{};
+        return pool;
+    }
+}
+
+namespace fsm {
+
+/**
+ * Takes a free frame.
+ *
+ * @param size Size requested by the compiler.
+ * @return The frame, or `nullptr` if it is too large or none is free.
+ */
+void* FramePool::allocate(const size_t size) noexcept {
+    Frames& pool = frames();
+    if (size <= FSM_COROUTINE_FRAME_SIZE) {
+        for (uint8_t i = 0; i < FSM_COROUTINE_FRAMES; i++) {
+            if (!pool.used[i]) {
+                pool.used[i] = true;
+                return pool.storage[i];
+            }
+        }
+    }
+    pool.failures++;
+    return nullptr;
+}
+
+/**
+ * Returns a frame to the pool.
+ *
+ * @param frame Frame returned by `allocate`.
+ */
+void FramePool::release(void* frame) noexcept {
+    Frames& pool = frames();
+    for (uint8_t i = 0; i < FSM_COROUTINE_FRAMES; i++) {
+        if (pool.storage[i] == frame) {
+            pool.used[i] = false;
+            return;
+        }
+    }
+}
+
+/**
+ * Retrieves the number of free frames.
+ *
+ * @return Frames available for new behaviors.
+ */
+uint8_t FramePool::getFree() noexcept {
+    const Frames& pool = frames();
+    uint8_t free = 0;
+    for (uint8_t i = 0; i < FSM_COROUTINE_FRAMES; i++) {
+        if (!pool.used[i]) free++;
+    }
+    return free;
+}
+
+/**
+ * Retrieves the number of failed allocations.
+ *
+ * @return Behaviors that could not start.
+ */
+unsigned long FramePool::getFailures() noexcept {
+    return frames().failures;
+}
+
+} // namespace fsm
+
+/**
+ * Constructs a coroutine state.
+ *
+ * @param eventSource Default source of `fsm::event` waits.
+ * @param timeout Optional state timeout in milliseconds.
+ */
+CoroutineState::CoroutineState(BaseEventSource* eventSource, const unsigned long timeout)
+    : State(timeout), events{eventSource} {
+    addAction(&driver);
+}
+
+/**
+ * Adds a transition taken once the behavior finishes.
+ *
+ * @param next The next state.
+ * @return A pointer to this state for method chaining.
+ */
+CoroutineState* CoroutineState::whenDone(State* next) {
+    addTransition(new ConditionTransition(next, [this] { return isDone(); }));
+    return this;
+}
+
+/**
+ * Starts a new behavior and runs it to its first wait.
+ */
+void CoroutineState::Driver::arm() {
+    owner.behavior = owner.behave();
+    owner.behavior.resume();
+    lastWait = owner.behavior.getWait();
+    waitStart = Clock::now();
+}
+
+/**
+ * Resumes the behavior if what it waits for has happened.
+ */
+void CoroutineState::Driver::execute() {
+    fsm::Wait* wait = owner.behavior.getWait();
+    if (!wait) return;
+
+    const unsigned long now = Clock::now();
+    if (wait != lastWait) {
+        // A wait not seen suspending: delays count from its first check
+        lastWait = wait;
+        waitStart = now;
+    }
+
+    bool ready = false;
+    switch (wait->kind) {
+        case fsm::Wait::DELAY:
+            ready = now - waitStart >= wait->duration;
+            break;
+        case fsm::Wait::EVENT: {
+            BaseEventSource* source = wait->source ? wait->source : owner.events;
+            Event* event = source ? source->getEvent() : Event::none;
+            if (event == wait->event) {
+                wait->received = event;
+                ready = true;
+            }
+            break;
+        }
+        case fsm::Wait::UNTIL:
+            ready = wait->condition && wait->condition();
+            break;
+    }
+    if (ready) {
+        // The next delay counts from this one's deadline, so a loop of delays does not drift
+        waitStart = wait->kind == fsm::Wait::DELAY ? waitStart + wait->duration : now;
+        owner.behavior.resume();
+        lastWait = owner.behavior.getWait();
+    }
+}
+
+/**
+ * Retrieves the time until the behavior may resume.
+ *
+ * @param time Receives the time in milliseconds; 0 means it must be checked now,
+ *             `Action::NOT_DUE` that it waits on an event or a condition.
+ * @return `true` while the behavior is suspended, `false` once it finished.
+ */
+bool CoroutineState::Driver::getTimeUntilDue(unsigned long& time) const {
+    const fsm::Wait* wait = owner.behavior.getWait();
+    if (!wait) return false;
+    time = 0;
+    if (wait != lastWait) return true;
+    if (wait->kind == fsm::Wait::DELAY) {
+        const unsigned long elapsed = Clock::now() - waitStart;
+        time = elapsed < wait->duration ? wait->duration - elapsed : 0;
+    } else {
+        time = Action::NOT_DUE;
+    }
+    return true;
+}
+
+#endif //FSM_COROUTINES
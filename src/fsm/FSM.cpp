@@ -5,6 +5,9 @@
 
 #include "fsm/FSM.h"
 #include "fsm/Transition.h"
+#include "fsm/EventTransition.h"
+#include "fsm/SnapshotCodec.h"
+#include "actions/Clock.h"
 #include "events/Event.h"
 
 /**
@@ -16,14 +19,235 @@
  * Postconditions:
  * - The FSM's `running` state is set to true.
  * - The current state is set to the initial state.
- * - The `onEnter` method of the initial state is invoked.
+ * - The `onEnter` method of the initial state is invoked and its actions are armed.
+ * - The state table is rebuilt (see `build`).
+ * - The observer, if any, is notified with no previous state.
  */
 
 void FSM::start() {
     if (!initialState) return;
+    build();
     currentState = initialState;
-    currentState->onEnter(nullptr);
+    currentState->enter(nullptr);
+    currentState->armActions();
     running = true;
+    if (observer) {
+        observer->onTransition(this, nullptr, currentState, nullptr);
+    }
+    cacheDeadline();
+}
+
+/**
+ * Builds the state table by walking the transition graph from the initial state.
+ *
+ * Behavior:
+ * - Visits states in breadth-first order, following every transition of every state.
+ * - Assigns each state its position as dense index.
+ * - Replaces any table built by a previous call, and rebuilds the transition matrix
+ *   if enabled.
+ */
+void FSM::build() {
+    delete[] states;
+    states = nullptr;
+    totalStates = 0;
+    if (!initialState) return;
+
+    uint16_t capacity = 8;
+    states = new State*[capacity];
+    initialState->setIndex(totalStates);
+    states[totalStates++] = initialState;
+
+    for (uint16_t i = 0; i < totalStates; i++) {
+        for (const Transition* tr = states[i]->getFirstTransition(); tr != nullptr; tr = tr->getNext()) {
+            State* next = tr->getNextState();
+            if (!next) continue;
+            // States added by this build carry their index, so the check is exact
+            const uint16_t index = next->getIndex();
+            if (index < totalStates && states[index] == next) continue;
+
+            if (totalStates == capacity) {
+                // Grows the table; this only happens while building, never in run()
+                State** grown = new State*[capacity * 2];
+                for (uint16_t j = 0; j < totalStates; j++) {
+                    grown[j] = states[j];
+                }
+                delete[] states;
+                states = grown;
+                capacity *= 2;
+            }
+            next->setIndex(totalStates);
+            states[totalStates++] = next;
+        }
+    }
+    buildMatrix();
+}
+
+/**
+ * Builds the state x event transition matrix, if enabled.
+ *
+ * Behavior:
+ * - Gives each distinct event expected by an event transition of this FSM a column,
+ *   in order of event ID, recorded in `columnOf` for the IDs from the lowest to the
+ *   highest expected one; events of other FSMs take no column.
+ * - One row per state of the table. Each cell holds the target of the first event
+ *   transition of the state expecting that event, so the matrix agrees with the
+ *   transition order of `checkTransitions`.
+ */
+void FSM::buildMatrix() {
+    delete[] matrix;
+    delete[] columnOf;
+    matrix = nullptr;
+    columnOf = nullptr;
+    matrixColumns = 0;
+    totalEventIds = 0;
+    if (!matrixEnabled) return;
+
+    uint16_t lowest = NO_COLUMN;
+    uint16_t highest = 0;
+    for (uint16_t i = 0; i < totalStates; i++) {
+        for (const Transition* tr = states[i]->getFirstTransition(); tr != nullptr; tr = tr->getNext()) {
+            if (!tr->isBuiltIn() || tr->getPriority() != EVENT_TRANSITION || !tr->getNextState()) continue;
+            const Event* expected = static_cast<const EventTransition*>(tr)->getExpectedEvent();
+            if (!expected) continue;
+            if (expected->getId() < lowest) lowest = expected->getId();
+            if (expected->getId() > highest) highest = expected->getId();
+        }
+    }
+    if (lowest > highest) return;
+
+    firstEventId = lowest;
+    totalEventIds = highest - lowest + 1;
+    columnOf = new uint16_t[totalEventIds];
+    for (uint16_t id = 0; id < totalEventIds; id++) {
+        columnOf[id] = NO_COLUMN;
+    }
+    for (uint16_t i = 0; i < totalStates; i++) {
+        for (const Transition* tr = states[i]->getFirstTransition(); tr != nullptr; tr = tr->getNext()) {
+            if (!tr->isBuiltIn() || tr->getPriority() != EVENT_TRANSITION || !tr->getNextState()) continue;
+            const Event* expected = static_cast<const EventTransition*>(tr)->getExpectedEvent();
+            if (expected) columnOf[expected->getId() - firstEventId] = 0;
+        }
+    }
+    // Number the expected events in ID order
+    for (uint16_t id = 0; id < totalEventIds; id++) {
+        if (columnOf[id] != NO_COLUMN) columnOf[id] = matrixColumns++;
+    }
+
+    const unsigned long cells = static_cast<unsigned long>(totalStates) * matrixColumns;
+    matrix = new uint16_t[cells];
+    for (unsigned long cell = 0; cell < cells; cell++) {
+        matrix[cell] = State::NO_INDEX;
+    }
+    for (uint16_t i = 0; i < totalStates; i++) {
+        uint16_t* row = matrix + static_cast<unsigned long>(i) * matrixColumns;
+        for (const Transition* tr = states[i]->getFirstTransition(); tr != nullptr; tr = tr->getNext()) {
+            if (!tr->isBuiltIn() || tr->getPriority() != EVENT_TRANSITION || !tr->getNextState()) continue;
+            const Event* expected = static_cast<const EventTransition*>(tr)->getExpectedEvent();
+            if (!expected) continue;
+            const uint16_t column = columnOf[expected->getId() - firstEventId];
+            if (row[column] == State::NO_INDEX) {
+                row[column] = indexOf(tr->getNextState());
+            }
+        }
+    }
+}
+
+/**
+ * Finds the position of a state in the state table.
+ *
+ * @param state The state to look for.
+ * @return The index of the state, or `-1` if it is not part of this FSM.
+ */
+int FSM::indexOf(const State* state) const {
+    const uint16_t index = state->getIndex();
+    if (index < totalStates && states[index] == state) return index;
+    // A state shared with another FSM carries that FSM's index
+    for (uint16_t i = 0; i < totalStates; i++) {
+        if (states[i] == state) return i;
+    }
+    return -1;
+}
+
+/**
+ * Encodes the FSM's execution state into a few bytes.
+ *
+ * Layout:
+ * - Header byte: version in the high nibble, running/timer/state flags in the low nibble.
+ * - Index of the current state in the state table (varint), if there is a current state.
+ * - Time left on the current state's timer, in the timer's unit (varint), if it is running.
+ *
+ * @param buffer Destination buffer.
+ * @param size Capacity of the buffer in bytes.
+ * @return The number of bytes written, or 0 if the buffer is too small.
+ */
+size_t FSM::snapshot(uint8_t* buffer, const size_t size) const {
+    SnapshotWriter writer(buffer, size);
+    const int index = currentState ? indexOf(currentState) : -1;
+    const bool timerRunning = index >= 0 && currentState->isStateTimerRunning();
+
+    uint8_t header = SNAPSHOT_VERSION << 4;
+    if (running) header |= SNAPSHOT_RUNNING;
+    if (timerRunning) header |= SNAPSHOT_TIMER;
+    if (index >= 0) header |= SNAPSHOT_STATE;
+    writer.writeByte(header);
+
+    if (index >= 0) {
+        writer.writeVarint(index);
+    }
+    if (timerRunning) {
+        writer.writeVarint(currentState->getRemainingTime());
+    }
+    return writer.getLength();
+}
+
+/**
+ * Resumes the FSM from a snapshot.
+ *
+ * Behavior:
+ * - Rejects snapshots of another version or whose state index is out of range.
+ * - Optionally invokes `onEnter` on the restored state, then overrides its timer
+ *   with the saved remaining time (or stops it if it was not running).
+ * - Restarts the actions of the restored state; their progress is not part of the snapshot.
+ *
+ * @param buffer Snapshot produced by `snapshot`.
+ * @param size Length of the snapshot in bytes.
+ * @param reenter Whether to invoke the restored state's `onEnter`.
+ * @return `true` if the snapshot was valid and applied, `false` otherwise.
+ */
+bool FSM::restore(const uint8_t* buffer, const size_t size, const bool reenter) {
+    SnapshotReader reader(buffer, size);
+    const uint8_t header = reader.readByte();
+    if (!reader.isValid() || (header >> 4) != SNAPSHOT_VERSION) return false;
+
+    if (!states) build();
+
+    State* state = nullptr;
+    if (header & SNAPSHOT_STATE) {
+        const unsigned long index = reader.readVarint();
+        if (index >= totalStates) return false;
+        state = states[index];
+    }
+    const unsigned long remaining = (header & SNAPSHOT_TIMER) ? reader.readVarint() : 0;
+    if (!reader.isValid()) return false;
+
+    if (currentState) {
+        currentState->disarmActions();
+    }
+    currentState = state;
+    if (currentState) {
+        if (reenter) {
+            currentState->enter(nullptr);
+        }
+        currentState->armActions();
+        if (header & SNAPSHOT_TIMER) {
+            currentState->resumeStateTimer(remaining);
+        } else {
+            currentState->stopStateTimer();
+        }
+        cacheDeadline();
+    }
+    running = (header & SNAPSHOT_RUNNING) && currentState;
+    return true;
 }
 
 /**
@@ -45,29 +269,150 @@ void FSM::restart() {
  * Executes a single FSM update cycle.
  *
  * Behavior:
- * - If a triggered transition is detected, the FSM transitions to the corresponding state.
+ * - Presents the next posted event, if the FSM has a queue.
+ * - If a triggered transition is detected, the FSM transitions to the corresponding state
+ *   and notifies the observer, if any.
+ * - Up to `maxHops` transitions are followed in the same call. The posted event only
+ *   triggers the first one, and a transition without a next state ends the chain.
+ * - Reaching `maxHops` after re-entering a state visited in this call counts a hop
+ *   limit hit, see `getHopLimitHits`.
  * - If no transitions are triggered, invokes the `onUpdate` method of the current state.
+ * - A state whose transitions are all timeouts is not checked until its timer is due,
+ *   which is found by comparing the deadline cached on entry with the time read once
+ *   for the run.
+ * - Executes the due actions of the state the FSM ends in.
  *
  * Preconditions:
  * - The FSM must have a currentState state and be running state.
+ *
+ * @return The number of state changes made.
  */
-void FSM::run() {
-    if (!running || !currentState) { return; }
+uint8_t FSM::run() {
+    if (!running || !currentState) { return 0; }
+    if (queue) {
+        queue->advance();
+    }
+
+    // A state left only through its timer has nothing to check before its deadline.
+    // Hooks restarting the timer only move it later, which the next check caches.
+    if (currentState->isTimeoutOnly()) {
+        const unsigned long now = Clock::now();
+        const unsigned long tick = timerMicros ? Clock::now(TimeUnit::MICROSECONDS) : now;
+        if (!timerArmed || static_cast<long>(tick - timerDeadline) < 0) {
+            currentState->update();
+            currentState->runActions(now);
+            return 0;
+        }
+    }
 
-    const Transition* triggeredTransition = currentState->checkTransitions();
+    uint8_t hops = 0;
+    bool reentered = false;
+    if (visited) {
+        visited[0] = currentState;
+    }
+    while (hops < maxHops) {
+        const Transition* triggeredTransition = currentState->checkTransitions();
+        if (!triggeredTransition) {
+            if (hops == 0) {
+                currentState->update();
+            }
+            break;
+        }
 
-    if (triggeredTransition) {
         State* nextState = triggeredTransition->getNextState();
-        Event* event = triggeredTransition->getLastEvent();
-        if (nextState) {
-            currentState->onExit(event);
+        if (!nextState) break;
+
+        changeState(nextState, triggeredTransition->getLastEvent());
+        hops++;
+        if (queue) {
+            queue->consume();
+        }
+        if (visited) {
+            for (uint8_t i = 0; i < hops && !reentered; i++) {
+                reentered = visited[i] == nextState;
+            }
+            visited[hops] = nextState;
+        }
+        if (hops == maxHops && reentered) {
+            // A state entered twice in one run: the chain goes around a cycle
+            hopLimitHits++;
 #ifdef FSM_DEBUG
-            logStateTransition(currentState, nextState);
+            Serial.print(F("FSM hop limit reached in state "));
+            Serial.println(currentState->getId());
 #endif
-            currentState = nextState;
-            currentState->onEnter(event);
         }
+    }
+
+    // Checking the timer re-arms it, so the deadline moves even without a hop
+    cacheDeadline();
+    currentState->runActions();
+    return hops;
+}
+
+/**
+ * Caches the deadline of the current state's timer for the check-free path of `run`.
+ */
+void FSM::cacheDeadline() {
+    timerArmed = currentState->isStateTimerRunning();
+    timerDeadline = currentState->getTimerDeadline();
+    timerMicros = currentState->getTimeUnit() == TimeUnit::MICROSECONDS;
+}
+
+/**
+ * Leaves the current state for another one.
+ *
+ * Behavior:
+ * - Disarms the actions of the current state and invokes its `onExit`.
+ * - Invokes `onEnter` of the next state, arms its actions and notifies the observer.
+ *
+ * @param nextState The state to enter.
+ * @param event The event causing the change, or `nullptr`.
+ */
+void FSM::changeState(State* nextState, Event* event) {
+    currentState->disarmActions();
+    currentState->exit(event);
+#ifdef FSM_DEBUG
+    logStateTransition(currentState, nextState);
+#endif
+    State* previousState = currentState;
+    currentState = nextState;
+    currentState->enter(event);
+    currentState->armActions();
+    if (observer) {
+        observer->onTransition(this, previousState, currentState, event);
+    }
+    cacheDeadline();
+}
+
+/**
+ * Delivers an event directly to the event transitions of the current state.
+ *
+ * @param event The event.
+ * @return `true` if the FSM changed state, `false` otherwise.
+ */
+bool FSM::dispatch(Event* event) {
+    if (!running || !currentState || !event) return false;
+
+    State* nextState = nullptr;
+    if (matrix) {
+        const int row = indexOf(currentState);
+        // Unsigned wrap-around rejects IDs below `firstEventId` too
+        const uint16_t id = event->getId() - firstEventId;
+        if (row < 0 || id >= totalEventIds || columnOf[id] == NO_COLUMN) return false;
+        const uint16_t target = matrix[static_cast<unsigned long>(row) * matrixColumns + columnOf[id]];
+        if (target == State::NO_INDEX) return false;
+        nextState = states[target];
     } else {
-        currentState->onUpdate();
+        for (const Transition* tr = currentState->getFirstTransition(); tr != nullptr; tr = tr->getNext()) {
+            if (tr->isBuiltIn() && tr->getPriority() == EVENT_TRANSITION && tr->getNextState()
+                && static_cast<const EventTransition*>(tr)->getExpectedEvent() == event) {
+                nextState = tr->getNextState();
+                break;
+            }
+        }
+        if (!nextState) return false;
     }
+
+    changeState(nextState, event);
+    return true;
 }
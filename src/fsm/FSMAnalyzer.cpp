@@ -0,0 +1,253 @@
+/**
+ * Implements the FSMAnalyzer class: transition classification, reachability
+ * and immediate-cycle detection over the state table of an FSM.
+ */
+
+#include "fsm/FSMAnalyzer.h"
+#include "fsm/ConditionTransition.h"
+#include "fsm/EventTransition.h"
+#include "fsm/PriorityTransition.h"
+
+/**
+ * Invokes the issue handler, if any, and updates the summary counters.
+ *
+ * @param result Summary to update.
+ * @param issue Kind of problem.
+ * @param state State where the problem was found.
+ * @param transition Transition involved, or `nullptr` for state issues.
+ */
+void FSMAnalyzer::report(FSMAnalysis& result, const AnalysisIssue issue, const State* state,
+                         const Transition* transition) const {
+    switch (issue) {
+        case AnalysisIssue::UNREACHABLE_STATE:    result.unreachableStates++; break;
+        case AnalysisIssue::SHADOWED_TRANSITION:  result.shadowedTransitions++; break;
+        case AnalysisIssue::DUPLICATE_TRANSITION: result.duplicateTransitions++; break;
+        case AnalysisIssue::DEAD_TRANSITION:      result.deadTransitions++; break;
+        case AnalysisIssue::IMMEDIATE_CYCLE:      result.immediateCycles++; break;
+    }
+    if (handler) {
+        handler(issue, state, transition);
+    }
+}
+
+/**
+ * Checks whether two built-in transitions of the same priority have the same trigger.
+ *
+ * @param a First transition.
+ * @param b Second transition.
+ * @return `true` if `b` can only trigger when `a` would already have triggered.
+ */
+bool FSMAnalyzer::sameTrigger(const Transition* a, const Transition* b) {
+    switch (a->getPriority()) {
+        case PRIORITY_TRANSITION: {
+            const auto pa = static_cast<const PriorityTransition*>(a);
+            const auto pb = static_cast<const PriorityTransition*>(b);
+            return pa->getExpectedEvent() == pb->getExpectedEvent() &&
+                   pa->getEventSource() == pb->getEventSource() &&
+                   (pa->hasTimeout() || !pb->hasTimeout());
+        }
+        case CONDITION_TRANSITION: {
+            // Lambdas with captures cannot be compared
+            const auto condition = static_cast<const ConditionTransition*>(a)->getCondition();
+            return condition && condition == static_cast<const ConditionTransition*>(b)->getCondition();
+        }
+        case EVENT_TRANSITION: {
+            const auto ea = static_cast<const EventTransition*>(a);
+            const auto eb = static_cast<const EventTransition*>(b);
+            return ea->getExpectedEvent() == eb->getExpectedEvent() && ea->getEventSource() == eb->getEventSource();
+        }
+        default:
+            // Timeout and immediate transitions are handled as shadowing
+            return false;
+    }
+}
+
+/**
+ * Classifies a transition, in evaluation order.
+ *
+ * @param state Owner of the transition.
+ * @param transition Transition to classify.
+ * @param timerTaken Set once a live transition consumes the state's timeout.
+ * @param immediateTaken Set once a live immediate transition is found.
+ * @param issue Receives the problem found, if any.
+ * @return `true` if the transition can never fire, `false` otherwise.
+ */
+bool FSMAnalyzer::findIssue(const State* state, const Transition* transition, bool& timerTaken,
+                            bool& immediateTaken, AnalysisIssue& issue) {
+    if (!transition->isBuiltIn()) return false;
+
+    switch (transition->getPriority()) {
+        case PRIORITY_TRANSITION: {
+            const auto tr = static_cast<const PriorityTransition*>(transition);
+            const bool eventLive = tr->getExpectedEvent() && tr->getEventSource();
+            const bool timeoutLive = tr->hasTimeout() && state->hasTimer() && !timerTaken;
+            if (!eventLive && !timeoutLive) {
+                issue = tr->hasTimeout() && state->hasTimer() ? AnalysisIssue::SHADOWED_TRANSITION
+                                                              : AnalysisIssue::DEAD_TRANSITION;
+                return true;
+            }
+            break;
+        }
+        case CONDITION_TRANSITION:
+            if (!static_cast<const ConditionTransition*>(transition)->hasCondition()) {
+                issue = AnalysisIssue::DEAD_TRANSITION;
+                return true;
+            }
+            break;
+        case EVENT_TRANSITION: {
+            const auto tr = static_cast<const EventTransition*>(transition);
+            if (!tr->getExpectedEvent() || !tr->getEventSource()) {
+                issue = AnalysisIssue::DEAD_TRANSITION;
+                return true;
+            }
+            break;
+        }
+        case TIMEOUT_TRANSITION:
+            if (!state->hasTimer()) {
+                issue = AnalysisIssue::DEAD_TRANSITION;
+                return true;
+            }
+            if (timerTaken) {
+                issue = AnalysisIssue::SHADOWED_TRANSITION;
+                return true;
+            }
+            timerTaken = true;
+            return false;
+        case IMMEDIATE_TRANSITION:
+            if (immediateTaken) {
+                issue = AnalysisIssue::SHADOWED_TRANSITION;
+                return true;
+            }
+            immediateTaken = true;
+            return false;
+    }
+
+    // Earlier transitions of the same priority with the same trigger win
+    for (const Transition* tr = state->getFirstTransition(); tr != transition; tr = tr->getNext()) {
+        if (tr->isBuiltIn() && tr->getPriority() == transition->getPriority() && sameTrigger(tr, transition)) {
+            issue = AnalysisIssue::DUPLICATE_TRANSITION;
+            return true;
+        }
+    }
+
+    if (transition->getPriority() == PRIORITY_TRANSITION &&
+        static_cast<const PriorityTransition*>(transition)->hasTimeout() && state->hasTimer()) {
+        timerTaken = true;
+    }
+    return false;
+}
+
+/**
+ * Runs the analysis.
+ *
+ * Behavior:
+ * - Walks the states breadth-first from the initial state, following live transitions only.
+ * - Classifies the transitions of every state visited, in evaluation order.
+ * - Reports states of the FSM, or declared states, that were never visited.
+ * - Follows the first live immediate transition of each state to find cycles.
+ *
+ * @param removeDead Whether to unlink the transitions that can never fire.
+ * @return The analysis summary.
+ */
+FSMAnalysis FSMAnalyzer::run(const bool removeDead) {
+    FSMAnalysis result;
+    fsm->build();
+    const uint16_t total = fsm->getTotalStates();
+    if (total == 0) return result;
+
+    State** queue = new State*[total];
+    bool* visited = new bool[total];
+    int* immediateNext = new int[total];
+    Transition** immediate = new Transition*[total];
+    for (uint16_t i = 0; i < total; i++) {
+        visited[i] = false;
+        immediateNext[i] = -1;
+        immediate[i] = nullptr;
+    }
+
+    uint16_t head = 0;
+    uint16_t tail = 0;
+    queue[tail++] = fsm->getInitialState();
+    visited[0] = true;
+
+    while (head < tail) {
+        State* state = queue[head++];
+        const int index = fsm->indexOf(state);
+        bool timerTaken = false;
+        bool immediateTaken = false;
+
+        for (auto priority = PRIORITY_TRANSITION; priority <= IMMEDIATE_TRANSITION;
+             priority = static_cast<TransitionPriority>(priority + 1)) {
+            Transition* tr = state->getFirstTransition();
+            while (tr != nullptr) {
+                Transition* next = tr->getNext();
+                if (tr->getPriority() == priority) {
+                    AnalysisIssue issue;
+                    if (findIssue(state, tr, timerTaken, immediateTaken, issue)) {
+                        report(result, issue, state, tr);
+                        if (removeDead && state->removeTransition(tr)) {
+                            result.prunedTransitions++;
+                        }
+                    } else if (tr->getNextState()) {
+                        const int target = fsm->indexOf(tr->getNextState());
+                        if (priority == IMMEDIATE_TRANSITION) {
+                            immediateNext[index] = target;
+                            immediate[index] = tr;
+                        }
+                        if (!visited[target]) {
+                            visited[target] = true;
+                            queue[tail++] = tr->getNextState();
+                        }
+                    }
+                }
+                tr = next;
+            }
+        }
+    }
+    result.reachableStates = tail;
+
+    for (uint16_t i = 0; i < total; i++) {
+        if (!visited[i]) {
+            report(result, AnalysisIssue::UNREACHABLE_STATE, fsm->getState(i), nullptr);
+        }
+    }
+    for (uint16_t i = 0; i < totalDeclared; i++) {
+        if (declaredStates[i] && fsm->indexOf(declaredStates[i]) < 0) {
+            report(result, AnalysisIssue::UNREACHABLE_STATE, declaredStates[i], nullptr);
+        }
+    }
+
+    // Each state has at most one live immediate edge, so every walk is a simple path.
+    // 0: not seen, 1: on the current path, 2: done.
+    uint8_t* color = new uint8_t[total];
+    for (uint16_t i = 0; i < total; i++) {
+        color[i] = 0;
+    }
+    for (uint16_t i = 0; i < total; i++) {
+        if (color[i] != 0) continue;
+        int current = i;
+        while (current >= 0 && color[current] == 0) {
+            color[current] = 1;
+            current = immediateNext[current];
+        }
+        if (current >= 0 && color[current] == 1) {
+            report(result, AnalysisIssue::IMMEDIATE_CYCLE, fsm->getState(current), immediate[current]);
+        }
+        current = i;
+        while (current >= 0 && color[current] == 1) {
+            color[current] = 2;
+            current = immediateNext[current];
+        }
+    }
+
+    delete[] color;
+    delete[] queue;
+    delete[] visited;
+    delete[] immediateNext;
+    delete[] immediate;
+
+    if (removeDead) {
+        fsm->build();
+    }
+    return result;
+}
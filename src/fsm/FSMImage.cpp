@@ -0,0 +1,160 @@
+/**
+ * Implements the FSMImage and FSMImageWriter classes: header checks, record
+ * verification and image writing.
+ */
+
+#include "fsm/FSMImage.h"
+
+namespace {
+    const uint8_t MAGIC[4] = { 'F', 'S', 'M', 'I' }; ///< First bytes of every image.
+}
+
+/**
+ * Attaches the view to an image.
+ *
+ * @param bytes First byte of the image.
+ * @param size Size of the image in bytes.
+ * @return `true` if the header is valid and the records fit, `false` otherwise.
+ */
+bool FSMImage::load(const uint8_t* bytes, const size_t size) {
+    data = nullptr;
+    totalStates = 0;
+    totalTransitions = 0;
+    if (!bytes || size < HEADER_SIZE || memcmp(bytes, MAGIC, sizeof(MAGIC)) != 0) return false;
+    if (read16(bytes + 4) != VERSION) return false;
+
+    const uint32_t states = read32(bytes + 8);
+    const uint32_t transitions = read32(bytes + 12);
+    // Checked by division, so huge counts cannot wrap the size computation
+    if (states == 0 || states > (size - HEADER_SIZE) / STATE_SIZE) return false;
+    if (transitions > (size - HEADER_SIZE - states * STATE_SIZE) / TRANSITION_SIZE) return false;
+
+    data = bytes;
+    totalStates = states;
+    totalTransitions = transitions;
+    return true;
+}
+
+/**
+ * Checks every record of the loaded image.
+ *
+ * @return `true` if the image is consistent, `false` otherwise.
+ */
+bool FSMImage::verify() const {
+    if (!data) return false;
+    for (uint32_t s = 0; s < totalStates; s++) {
+        const uint32_t first = getFirstTransition(s);
+        const uint16_t count = getTransitionCount(s);
+        if (first > totalTransitions || count > totalTransitions - first) return false;
+
+        uint8_t previousKind = PRIORITY_TRANSITION;
+        for (uint32_t t = first; t < first + count; t++) {
+            const uint8_t kind = getKind(t);
+            if (kind > IMMEDIATE_TRANSITION || kind < previousKind) return false;
+            if (getTarget(t) >= totalStates) return false;
+            const uint8_t flags = transition(t)[5];
+            if (flags & ~TIMEOUT_FLAG || (flags && kind != PRIORITY_TRANSITION)) return false;
+            if (kind == CONDITION_TRANSITION && getGuard(t) == NO_BINDING) return false;
+            if (kind == EVENT_TRANSITION && (getEvent(t) == NO_BINDING || getSource(t) == NO_BINDING)) return false;
+            // A priority transition fires on its event, its timeout, or both
+            if (kind == PRIORITY_TRANSITION && (getEvent(t) == NO_BINDING) != (getSource(t) == NO_BINDING)) return false;
+            if (kind == PRIORITY_TRANSITION && getSource(t) == NO_BINDING && !flags) return false;
+            previousKind = kind;
+        }
+    }
+    return true;
+}
+
+/**
+ * Constructs a writer and writes the header.
+ *
+ * @param destination Destination buffer.
+ * @param size Capacity of the buffer in bytes.
+ * @param stateCount Number of states the image will hold.
+ * @param transitionCount Number of transitions the image will hold.
+ */
+FSMImageWriter::FSMImageWriter(uint8_t* destination, const size_t size, const uint32_t stateCount,
+                               const uint32_t transitionCount)
+    : buffer{destination}, totalStates{stateCount}, totalTransitions{transitionCount},
+      valid{destination && size >= FSMImage::sizeFor(stateCount, transitionCount)} {
+    if (!valid) return;
+    memcpy(buffer, MAGIC, sizeof(MAGIC));
+    write16(buffer + 4, FSMImage::VERSION);
+    write16(buffer + 6, 0);
+    write32(buffer + 8, totalStates);
+    write32(buffer + 12, totalTransitions);
+}
+
+/**
+ * Appends a state.
+ *
+ * @param timeout Timeout in milliseconds, or 0 for none.
+ * @param enter ID of the enter hook.
+ * @param exit ID of the exit hook.
+ * @param update ID of the update hook.
+ * @return `true` if written, `false` if all declared states were written.
+ */
+bool FSMImageWriter::addState(const uint32_t timeout, const uint16_t enter, const uint16_t exit, const uint16_t update) {
+    if (!valid || states >= totalStates) return false;
+    uint8_t* record = buffer + FSMImage::HEADER_SIZE + states * FSMImage::STATE_SIZE;
+    write32(record, transitions);
+    write32(record + 4, timeout);
+    write16(record + 8, 0);
+    write16(record + 10, enter);
+    write16(record + 12, exit);
+    write16(record + 14, update);
+    states++;
+    return true;
+}
+
+/**
+ * Appends a transition to the last state added.
+ *
+ * @param kind Kind of the transition.
+ * @param target Index of the next state.
+ * @param guard ID of the guard.
+ * @param event ID of the expected event.
+ * @param source ID of the event source.
+ * @param withTimeout Whether the state's timeout also fires a priority transition.
+ * @return `true` if written, `false` if no state was added or all declared transitions were written.
+ */
+bool FSMImageWriter::addTransition(const TransitionPriority kind, const uint32_t target, const uint16_t guard,
+                                   const uint16_t event, const uint16_t source, const bool withTimeout) {
+    if (!valid || states == 0 || transitions >= totalTransitions) return false;
+    uint8_t* state = buffer + FSMImage::HEADER_SIZE + (states - 1) * FSMImage::STATE_SIZE;
+    const uint16_t count = state[8] | (state[9] << 8);
+    if (count == 0xFFFF) return false;
+    write16(state + 8, count + 1);
+
+    uint8_t* record = buffer + FSMImage::sizeFor(totalStates, transitions);
+    write32(record, target);
+    record[4] = kind;
+    record[5] = withTimeout ? FSMImage::TIMEOUT_FLAG : 0;
+    write16(record + 6, guard);
+    write16(record + 8, event);
+    write16(record + 10, source);
+    transitions++;
+    return true;
+}
+
+/**
+ * Completes the image.
+ *
+ * @return The size of the image, or 0 if records are missing or did not fit.
+ */
+size_t FSMImageWriter::finish() const {
+    if (!valid || states != totalStates || transitions != totalTransitions) return 0;
+    return FSMImage::sizeFor(totalStates, totalTransitions);
+}
+
+void FSMImageWriter::write16(uint8_t* bytes, const uint16_t value) {
+    bytes[0] = value & 0xFF;
+    bytes[1] = value >> 8;
+}
+
+void FSMImageWriter::write32(uint8_t* bytes, const uint32_t value) {
+    bytes[0] = value & 0xFF;
+    bytes[1] = (value >> 8) & 0xFF;
+    bytes[2] = (value >> 16) & 0xFF;
+    bytes[3] = value >> 24;
+}
@@ -0,0 +1,282 @@
+/**
+ * Implements the FSMRuntime class: ready list, deadline heap and stepping.
+ */
+
+#include "fsm/FSMRuntime.h"
+#include "actions/Clock.h"
+
+/**
+ * Constructs a runtime.
+ *
+ * @param maxMachines Maximum number of FSMs.
+ */
+FSMRuntime::FSMRuntime(const uint16_t maxMachines)
+    : machines{new Machine[maxMachines]}, capacity{maxMachines},
+      heap{new uint16_t[maxMachines]}, polled{new uint16_t[maxMachines]} { }
+
+FSMRuntime::~FSMRuntime() {
+    delete[] machines;
+    delete[] heap;
+    delete[] polled;
+}
+
+/**
+ * Registers an FSM.
+ *
+ * @param fsm The FSM.
+ * @param isPolled Step the FSM on every `run`.
+ * @return The handle of the FSM, or -1 if the runtime is full.
+ */
+int FSMRuntime::add(FSM* fsm, const bool isPolled) {
+    if (total >= capacity) return -1;
+    const uint16_t handle = total++;
+    Machine& machine = machines[handle];
+    machine.fsm = fsm;
+    machine.deadline = 0;
+    machine.heapIndex = NONE;
+    machine.nextReady = NONE;
+    machine.ready = false;
+    machine.polled = isPolled;
+    if (isPolled) {
+        polled[totalPolled++] = handle;
+    }
+    return handle;
+}
+
+/**
+ * Starts every registered FSM that is not running and marks all of them ready.
+ */
+void FSMRuntime::start() {
+    for (uint16_t handle = 0; handle < total; handle++) {
+        if (!machines[handle].fsm->isRunning()) {
+            machines[handle].fsm->start();
+        }
+        markReady(handle);
+        schedule(handle);
+    }
+}
+
+/**
+ * Posts an event to an FSM's queue and marks it ready.
+ *
+ * @param handle Handle returned by `add`.
+ * @param event The event to deliver.
+ * @return `true` if queued, `false` if the FSM has no queue or it is full.
+ */
+bool FSMRuntime::post(const uint16_t handle, Event* event) {
+    if (handle >= total || !machines[handle].fsm->post(event)) return false;
+    markReady(handle);
+    return true;
+}
+
+/**
+ * Marks an FSM ready.
+ *
+ * @param handle Handle returned by `add`.
+ */
+void FSMRuntime::wake(const uint16_t handle) {
+    if (handle < total) {
+        markReady(handle);
+    }
+}
+
+/**
+ * Appends an FSM to the ready list, unless it is already there or polled.
+ *
+ * @param handle Handle of the FSM.
+ */
+void FSMRuntime::markReady(const uint16_t handle) {
+    Machine& machine = machines[handle];
+    if (machine.ready || machine.polled) return;
+    machine.ready = true;
+    machine.nextReady = NONE;
+    if (readyTail == NONE) {
+        readyHead = handle;
+    } else {
+        machines[readyTail].nextReady = handle;
+    }
+    readyTail = handle;
+}
+
+/**
+ * Steps the polled FSMs, the FSMs whose deadline passed and the ready ones.
+ *
+ * @return The number of FSM steps performed.
+ */
+uint16_t FSMRuntime::run() {
+    const unsigned long now = Clock::now();
+    while (heapSize > 0 && !isBefore(now, machines[heap[0]].deadline)) {
+        const uint16_t handle = heap[0];
+        heapRemove(handle);
+        markReady(handle);
+    }
+
+    // Detach the current list, so FSMs made ready by their own step wait for the next pass
+    uint16_t handle = readyHead;
+    readyHead = NONE;
+    readyTail = NONE;
+
+    uint16_t steps = 0;
+    while (handle != NONE) {
+        const uint16_t next = machines[handle].nextReady;
+        machines[handle].ready = false;
+        step(handle);
+        steps++;
+        handle = next;
+    }
+    for (uint16_t i = 0; i < totalPolled; i++) {
+        step(polled[i]);
+        steps++;
+    }
+    totalSteps += steps;
+    return steps;
+}
+
+/**
+ * Runs an FSM once and reschedules it.
+ *
+ * Behavior:
+ * - An FSM that changed state, or still has queued events, is ready again, since
+ *   its new state may have an immediate transition or accept the next event.
+ * - Its deadline follows the timer of its (possibly new) state.
+ *
+ * @param handle Handle of the FSM.
+ */
+void FSMRuntime::step(const uint16_t handle) {
+    FSM* fsm = machines[handle].fsm;
+    const State* before = fsm->getCurrentState();
+    fsm->run();
+    const EventQueue* queue = fsm->getQueue();
+    if (fsm->getCurrentState() != before || (queue && !queue->isEmpty())) {
+        markReady(handle);
+    }
+    schedule(handle);
+}
+
+/**
+ * Updates the heap entry of an FSM from its current state's timer and actions.
+ *
+ * @param handle Handle of the FSM.
+ */
+void FSMRuntime::schedule(const uint16_t handle) {
+    Machine& machine = machines[handle];
+    if (machine.polled) return;
+
+    const State* state = machine.fsm->getCurrentState();
+    if (!machine.fsm->isRunning() || !state) {
+        heapRemove(handle);
+        return;
+    }
+
+    // The earliest of the state timer and the state's actions
+    bool timed = state->isStateTimerRunning();
+    unsigned long remaining = timed ? state->getRemainingTime() : 0;
+    if (state->getTimeUnit() == TimeUnit::MICROSECONDS) {
+        // Rounded down: the FSM is stepped during the last millisecond until it fires
+        remaining /= 1000UL;
+    }
+    unsigned long actionTime;
+    if (state->getActionTime(actionTime) && (!timed || actionTime < remaining)) {
+        remaining = actionTime;
+        timed = true;
+    }
+    if (!timed) {
+        heapRemove(handle);
+        return;
+    }
+
+    const unsigned long deadline = Clock::now() + remaining;
+    if (machine.heapIndex == NONE) {
+        machine.deadline = deadline;
+        machine.heapIndex = heapSize;
+        heap[heapSize++] = handle;
+        heapUp(machine.heapIndex);
+    } else if (deadline != machine.deadline) {
+        const bool earlier = isBefore(deadline, machine.deadline);
+        machine.deadline = deadline;
+        if (earlier) {
+            heapUp(machine.heapIndex);
+        } else {
+            heapDown(machine.heapIndex);
+        }
+    }
+}
+
+/**
+ * Removes an FSM from the heap, if present.
+ *
+ * @param handle Handle of the FSM.
+ */
+void FSMRuntime::heapRemove(const uint16_t handle) {
+    const uint16_t index = machines[handle].heapIndex;
+    if (index == NONE) return;
+    machines[handle].heapIndex = NONE;
+
+    const uint16_t last = heap[--heapSize];
+    if (index == heapSize) return;
+    heapPlace(index, last);
+    if (index > 0 && isBefore(machines[last].deadline, machines[heap[(index - 1) / 2]].deadline)) {
+        heapUp(index);
+    } else {
+        heapDown(index);
+    }
+}
+
+/**
+ * Moves an entry towards the root while its deadline is earlier than its parent's.
+ *
+ * @param index Position of the entry.
+ */
+void FSMRuntime::heapUp(uint16_t index) {
+    const uint16_t handle = heap[index];
+    while (index > 0) {
+        const uint16_t parent = (index - 1) / 2;
+        if (!isBefore(machines[handle].deadline, machines[heap[parent]].deadline)) break;
+        heapPlace(index, heap[parent]);
+        index = parent;
+    }
+    heapPlace(index, handle);
+}
+
+/**
+ * Moves an entry towards the leaves while a child has an earlier deadline.
+ *
+ * @param index Position of the entry.
+ */
+void FSMRuntime::heapDown(uint16_t index) {
+    const uint16_t handle = heap[index];
+    while (true) {
+        uint16_t child = 2 * index + 1;
+        if (child >= heapSize) break;
+        if (child + 1 < heapSize && isBefore(machines[heap[child + 1]].deadline, machines[heap[child]].deadline)) {
+            child++;
+        }
+        if (!isBefore(machines[heap[child]].deadline, machines[handle].deadline)) break;
+        heapPlace(index, heap[child]);
+        index = child;
+    }
+    heapPlace(index, handle);
+}
+
+/**
+ * Stores a handle at a heap position and records the position.
+ *
+ * @param index Heap position.
+ * @param handle Handle of the FSM.
+ */
+void FSMRuntime::heapPlace(const uint16_t index, const uint16_t handle) {
+    heap[index] = handle;
+    machines[handle].heapIndex = index;
+}
+
+/**
+ * Retrieves the earliest pending state-timer deadline.
+ *
+ * @param deadline Receives the deadline, in `Clock` time.
+ * @return `true` if a deadline is pending, `false` otherwise.
+ */
+bool FSMRuntime::getNextDeadline(unsigned long& deadline) const {
+    if (heapSize == 0) return false;
+    deadline = machines[heap[0]].deadline;
+    return true;
+}
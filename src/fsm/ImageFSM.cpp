@@ -0,0 +1,125 @@
+/**
+ * Implements the ImageFSM class: in-place transition evaluation and state changes.
+ */
+
+#include "fsm/ImageFSM.h"
+
+/**
+ * Enters state 0 and starts running.
+ */
+void ImageFSM::start() {
+    if (image.getTotalStates() == 0) return;
+    enter(0, nullptr);
+    running = true;
+}
+
+/**
+ * Executes one update cycle.
+ *
+ * @return `true` if the machine changed state, `false` otherwise.
+ */
+bool ImageFSM::run() {
+    if (!running) return false;
+
+    const uint32_t first = image.getFirstTransition(currentState);
+    const uint32_t last = first + image.getTransitionCount(currentState);
+    for (uint32_t transition = first; transition < last; transition++) {
+        // As in FSM: hooks receive the triggering event, or `Event::none`
+        Event* event = Event::none;
+        if (!isTriggered(transition, event)) continue;
+
+        callHook(image.getExitHook(currentState), event);
+        enter(image.getTarget(transition), event);
+        return true;
+    }
+    callHook(image.getUpdateHook(currentState), nullptr);
+    return false;
+}
+
+/**
+ * Evaluates a transition of the current state.
+ *
+ * @param transition Index of the transition.
+ * @param event Receives the event that triggered it, if any.
+ * @return `true` if the transition fires, `false` otherwise.
+ */
+bool ImageFSM::isTriggered(const uint32_t transition, Event*& event) {
+    const uint16_t guard = image.getGuard(transition);
+    switch (image.getKind(transition)) {
+        case PRIORITY_TRANSITION:
+            // Event first, then timeout, as in PriorityTransition
+            if (receive(transition, event) || (image.hasTimeout(transition) && timer.elapsed())) {
+                return guard == FSMImage::NO_BINDING || checkGuard(guard);
+            }
+            return false;
+        case CONDITION_TRANSITION:
+            return checkGuard(guard);
+        case EVENT_TRANSITION:
+            if (!receive(transition, event)) return false;
+            return guard == FSMImage::NO_BINDING || checkGuard(guard);
+        case TIMEOUT_TRANSITION:
+            if (!timer.elapsed()) return false;
+            return guard == FSMImage::NO_BINDING || checkGuard(guard);
+        case IMMEDIATE_TRANSITION:
+            return guard == FSMImage::NO_BINDING || checkGuard(guard);
+        default:
+            return false;
+    }
+}
+
+/**
+ * Polls the source of a transition for its expected event.
+ *
+ * @param transition Index of the transition.
+ * @param event Receives the event if it is the expected one.
+ * @return `true` if the expected event was received, `false` otherwise.
+ */
+bool ImageFSM::receive(const uint32_t transition, Event*& event) {
+    const uint16_t source = image.getSource(transition);
+    const uint16_t expected = image.getEvent(transition);
+    if (source >= bindings.totalSources || expected >= bindings.totalEvents) return false;
+    Event* received = bindings.sources[source]->getEvent();
+    if (received != bindings.events[expected]) return false;
+    event = received;
+    return true;
+}
+
+/**
+ * Calls a guard by ID.
+ *
+ * @param guard ID of the guard.
+ * @return The guard's result, or `false` if it is not bound.
+ */
+bool ImageFSM::checkGuard(const uint16_t guard) const {
+    return guard < bindings.totalGuards && bindings.guards[guard] && bindings.guards[guard]();
+}
+
+/**
+ * Calls a hook by ID, if bound.
+ *
+ * @param hook ID of the hook.
+ * @param event Event passed to the hook.
+ */
+void ImageFSM::callHook(const uint16_t hook, Event* event) const {
+    if (hook < bindings.totalHooks && bindings.hooks[hook]) {
+        bindings.hooks[hook](event);
+    }
+}
+
+/**
+ * Makes a state current: restarts the timer for its timeout and calls its enter hook.
+ *
+ * @param state Index of the state.
+ * @param event Event causing the change, or `nullptr`.
+ */
+void ImageFSM::enter(const uint32_t state, Event* event) {
+    currentState = state;
+    const uint32_t timeout = image.getTimeout(state);
+    if (timeout > 0) {
+        timer.setDuration(timeout);
+        timer.start();
+    } else {
+        timer.stop();
+    }
+    callHook(image.getEnterHook(state), event);
+}
@@ -5,29 +5,48 @@
 
 #include "fsm/State.h"
 #include "fsm/Transition.h"
+#include "fsm/ConditionTransition.h"
+#include "fsm/EventTransition.h"
+#include "fsm/PriorityTransition.h"
+#include "fsm/StateTimeoutTransition.h"
+#include "fsm/ImmediateTransition.h"
 #include "events/Event.h"
 #include "actions/AlarmTimer.h"
+#include "actions/Clock.h"
+
+namespace {
+    /**
+     * Checks whether a transition is a `StateTimeoutTransition`.
+     */
+    bool isTimeout(const Transition* transition) {
+        return transition->isBuiltIn() && transition->getPriority() == TIMEOUT_TRANSITION;
+    }
+}
 
 // Static member initialization.
 /**
  * Static counter to assign unique IDs to each state.
  */
-int8_t State::_ids = -1;
+uint16_t State::_ids = 0;
 
 /**
  * Constructs a state with an optional timeout duration.
  *
- * @param timeout Timeout duration in milliseconds. Defaults to 0 (no timeout).
+ * @param timeout Timeout duration in `unit`. Defaults to 0 (no timeout).
+ * @param unit Resolution of the timeout.
  */
-State::State(const unsigned long timeout) {
+State::State(const unsigned long timeout, const TimeUnit unit) {
     if (timeout > 0) {
-        stateTimer = new AlarmTimer(timeout);
+        stateTimer = new AlarmTimer(timeout, unit);
     }
 }
 
 /**
  * Adds a transition to the state.
  *
+ * The transition is linked after every transition of the same or higher priority,
+ * so the list is always in evaluation order.
+ *
  * @param transition Pointer to the transition to add.
  * @return A pointer to this state for method chaining.
  */
@@ -35,36 +54,228 @@ State* State::addTransition(Transition* transition) {
     if (firstTransition == nullptr) {
         firstTransition = transition;
         lastTransition = transition;
-    } else {
+    } else if (lastTransition->getPriority() <= transition->getPriority()) {
         lastTransition->setNext(transition);
         lastTransition = transition;
+    } else if (transition->getPriority() < firstTransition->getPriority()) {
+        transition->setNext(firstTransition);
+        firstTransition = transition;
+    } else {
+        Transition* previous = firstTransition;
+        while (previous->getNext()->getPriority() <= transition->getPriority()) {
+            previous = previous->getNext();
+        }
+        transition->setNext(previous->getNext());
+        previous->setNext(transition);
     }
     totalTransitions++;
+    timeoutOnly = timeoutOnly && isTimeout(transition);
     transition->setOwner(this);
     return this;
 }
 
+/**
+ * Removes a transition from the state.
+ *
+ * @param transition Pointer to the transition to remove.
+ * @return `true` if the transition belonged to this state, `false` otherwise.
+ */
+bool State::removeTransition(Transition* transition) {
+    Transition* previous = nullptr;
+    for (Transition* tr = firstTransition; tr != nullptr; tr = tr->getNext()) {
+        if (tr == transition) {
+            if (previous) {
+                previous->setNext(tr->getNext());
+            } else {
+                firstTransition = tr->getNext();
+            }
+            if (lastTransition == tr) {
+                lastTransition = previous;
+            }
+            if (triggeredTransition == tr) {
+                triggeredTransition = nullptr;
+            }
+            tr->setNext(nullptr);
+            totalTransitions--;
+            timeoutOnly = true;
+            for (const Transition* other = firstTransition; other != nullptr; other = other->getNext()) {
+                timeoutOnly = timeoutOnly && isTimeout(other);
+            }
+            return true;
+        }
+        previous = tr;
+    }
+    return false;
+}
+
 /**
  * Checks transitions for a triggered condition.
  *
+ * The transitions are already sorted by priority, so a single pass finds the first
+ * triggered one.
+ *
  * @return Pointer to the triggered transition, or `nullptr` if none are triggered.
  */
 Transition* State::checkTransitions() {
-    if (firstTransition) {
-        for (auto priority = PRIORITY_TRANSITION; priority <= IMMEDIATE_TRANSITION;
-             priority = static_cast<TransitionPriority>(priority + 1)) {
-            for (Transition* tr = firstTransition; tr != nullptr; tr = tr->getNext()) {
-                if (tr->getPriority() == priority && tr->isTriggered()) {
-                    triggeredTransition = tr;
-                    return tr;
-                }
-            }
+    for (Transition* tr = firstTransition; tr != nullptr; tr = tr->getNext()) {
+        if (isTriggered(tr)) {
+            triggeredTransition = tr;
+            return tr;
         }
     }
     triggeredTransition = nullptr;
     return nullptr;
 }
 
+/**
+ * Checks one transition of the state.
+ *
+ * Built-in transitions are told apart by their priority and checked through their
+ * final class, so the compiler calls (and usually inlines) their check directly;
+ * only custom transitions go through the virtual `isTriggered`.
+ *
+ * @param transition A transition of this state.
+ * @return `true` if the transition is triggered, `false` otherwise.
+ */
+bool State::isTriggered(Transition* transition) const {
+    if (!transition->isBuiltIn()) return transition->isTriggered();
+
+    switch (transition->getPriority()) {
+        case PRIORITY_TRANSITION:
+            return static_cast<PriorityTransition*>(transition)->PriorityTransition::isTriggered();
+        case CONDITION_TRANSITION:
+            return static_cast<ConditionTransition*>(transition)->ConditionTransition::isTriggered();
+        case EVENT_TRANSITION:
+            return static_cast<EventTransition*>(transition)->EventTransition::isTriggered();
+        case TIMEOUT_TRANSITION:
+            return isTimerElapsed();
+        case IMMEDIATE_TRANSITION:
+            return true;
+    }
+    return false;
+}
+
+/**
+ * Adds an action that runs only while this state is active.
+ *
+ * @param action Pointer to the action to add.
+ * @return A pointer to this state for method chaining.
+ */
+State* State::addAction(Action* action) {
+    action->disarm();
+    action->setNext(nullptr);
+    if (firstAction == nullptr) {
+        firstAction = action;
+    } else {
+        lastAction->setNext(action);
+    }
+    lastAction = action;
+    return this;
+}
+
+/**
+ * Arms the state's actions.
+ */
+void State::armActions() {
+    if (!firstAction) return;
+    for (Action* action = firstAction; action != nullptr; action = action->getNext()) {
+        action->arm();
+    }
+    updateActionsDue(Clock::now());
+}
+
+/**
+ * Disarms the state's actions.
+ */
+void State::disarmActions() {
+    for (Action* action = firstAction; action != nullptr; action = action->getNext()) {
+        action->disarm();
+    }
+    actionsPending = false;
+    actionsWaiting = false;
+}
+
+/**
+ * Executes the state's actions if the earliest of them is due, or on every call
+ * while one of them waits on something other than time.
+ */
+void State::runActions() {
+    if (!actionsPending && !actionsWaiting) return;
+    runActions(Clock::now());
+}
+
+/**
+ * Executes the state's actions if the earliest of them is due at a given time.
+ *
+ * Overrun policies apply as in `Scheduler`, in the order the actions were added:
+ * after a `SKIP_LOW_PRIORITY` overrun, the following actions of lower priority are
+ * skipped for the rest of the call and stay due; a `DEMOTE` overrun lowers the
+ * action to priority 0.
+ *
+ * @param now Current `Clock` time.
+ */
+void State::runActions(const unsigned long now) {
+    if (!actionsPending && !actionsWaiting) return;
+    if (!actionsWaiting && static_cast<long>(now - actionsDue) < 0) return;
+
+    bool skipping = false;
+    uint8_t floor = 0;
+    for (Action* action = firstAction; action != nullptr; action = action->getNext()) {
+        if (skipping && action->getPriority() < floor) continue;
+        ExecutionStats* stats = action->getStats();
+        if (!stats) {
+            action->execute();
+            continue;
+        }
+        const unsigned long start = micros();
+        action->execute();
+        if (!stats->record(micros() - start)) continue;
+
+        if (stats->getPolicy() == OverrunPolicy::SKIP_LOW_PRIORITY) {
+            skipping = true;
+            if (action->getPriority() > floor) floor = action->getPriority();
+        } else if (stats->getPolicy() == OverrunPolicy::DEMOTE) {
+            action->setPriority(0);
+        }
+    }
+    updateActionsDue(now);
+}
+
+/**
+ * Recomputes the earliest time an action needs to execute.
+ *
+ * @param now Current `Clock` time.
+ */
+void State::updateActionsDue(const unsigned long now) {
+    actionsPending = false;
+    actionsWaiting = false;
+    unsigned long earliest = 0;
+    for (const Action* action = firstAction; action != nullptr; action = action->getNext()) {
+        unsigned long time;
+        if (!action->getTimeUntilDue(time)) continue;
+        if (time == Action::NOT_DUE) {
+            actionsWaiting = true;
+        } else if (!actionsPending || time < earliest) {
+            earliest = time;
+            actionsPending = true;
+        }
+    }
+    actionsDue = now + earliest;
+}
+
+/**
+ * Retrieves the time until the next action of the state is due.
+ *
+ * @param time Receives the time in milliseconds; 0 means due now.
+ * @return `true` if an action waiting on time will execute again, `false` otherwise.
+ */
+bool State::getActionTime(unsigned long& time) const {
+    if (!actionsPending) return false;
+    const long left = static_cast<long>(actionsDue - Clock::now());
+    time = left > 0 ? left : 0;
+    return true;
+}
+
 /**
  * Checks whether the state's timer has elapsed.
  *
@@ -92,6 +303,60 @@ void State::stopStateTimer() const {
     }
 }
 
+/**
+ * Restarts the state's timer with a custom time until the timeout.
+ *
+ * @param remainingTime Time until the timeout in milliseconds.
+ */
+void State::resumeStateTimer(const unsigned long remainingTime) const {
+    if (stateTimer) {
+        stateTimer->resume(remainingTime);
+    }
+}
+
+/**
+ * Invokes `onEnter`, timing it if the state has a profile.
+ *
+ * @param event Pointer to the event triggering the transition. Can be `nullptr`.
+ */
+void State::enter(Event* event) const {
+    if (!profile) {
+        onEnter(event);
+        return;
+    }
+    const unsigned long start = micros();
+    onEnter(event);
+    profile->enter.record(micros() - start);
+}
+
+/**
+ * Invokes `onExit`, timing it if the state has a profile.
+ *
+ * @param event Pointer to the event triggering the transition. Can be `nullptr`.
+ */
+void State::exit(Event* event) const {
+    if (!profile) {
+        onExit(event);
+        return;
+    }
+    const unsigned long start = micros();
+    onExit(event);
+    profile->exit.record(micros() - start);
+}
+
+/**
+ * Invokes `onUpdate`, timing it if the state has a profile.
+ */
+void State::update() const {
+    if (!profile) {
+        onUpdate();
+        return;
+    }
+    const unsigned long start = micros();
+    onUpdate();
+    profile->update.record(micros() - start);
+}
+
 /**
  * Hook invoked when entering the state.
  *
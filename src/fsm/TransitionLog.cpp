@@ -0,0 +1,490 @@
+/**
+ * Implements the TransitionLog class: record encoding, group commit,
+ * compaction into a snapshot file and crash recovery.
+ */
+
+#include "fsm/TransitionLog.h"
+
+#if defined(__unix__) || defined(__APPLE__)
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "fsm/SnapshotCodec.h"
+
+#if defined(__APPLE__)
+    #define TRANSITION_LOG_SYNC(fd) fsync(fd)
+#else
+    #define TRANSITION_LOG_SYNC(fd) fdatasync(fd)
+#endif
+
+namespace {
+    constexpr uint8_t RECORD_MARKER = 0xA5;                    ///< First byte of every log record.
+    constexpr uint8_t SNAPSHOT_MAGIC[4] = { 'B', 'F', 'S', 'S' }; ///< First bytes of the snapshot file.
+
+    /**
+     * Reads a whole file into a heap buffer.
+     *
+     * @param fd Descriptor of the file, positioned anywhere.
+     * @param length Receives the file size.
+     * @return The buffer (to be released with `delete[]`), or `nullptr` if the file is empty or unreadable.
+     */
+    uint8_t* readFile(const int fd, size_t& length) {
+        length = 0;
+        struct stat info{};
+        if (fstat(fd, &info) != 0 || info.st_size <= 0) return nullptr;
+
+        uint8_t* data = new uint8_t[info.st_size];
+        size_t total = 0;
+        while (total < static_cast<size_t>(info.st_size)) {
+            const ssize_t n = pread(fd, data + total, info.st_size - total, total);
+            if (n < 0 && errno == EINTR) continue;
+            if (n <= 0) break;
+            total += n;
+        }
+        length = total;
+        return data;
+    }
+}
+
+/**
+ * Links an attached FSM to its log and instance ID.
+ */
+class TransitionLog::Binding final : public TransitionObserver {
+public:
+    TransitionLog* log;       ///< Log receiving the records.
+    FSM* fsm;                 ///< The attached FSM.
+    uint16_t instance;        ///< ID of the FSM across restarts.
+    uint8_t latest[FSM::SNAPSHOT_MAX_SIZE]{}; ///< Latest snapshot found during recovery.
+    uint8_t latestLength{0};  ///< Length of `latest`, 0 if none.
+
+    Binding(TransitionLog* owner, FSM* machine, const uint16_t id) : log{owner}, fsm{machine}, instance{id} { }
+
+    void onTransition(FSM* machine, const State*, const State*, const Event*) override {
+        log->append(instance, machine);
+    }
+};
+
+/**
+ * Constructs a transition log.
+ *
+ * @param log Path of the append-only log file.
+ * @param snapshot Path of the snapshot file written by compaction.
+ */
+TransitionLog::TransitionLog(const char* log, const char* snapshot) : logPath{log}, snapshotPath{snapshot} {
+    const size_t length = strlen(snapshot);
+    tempPath = new char[length + 5];
+    memcpy(tempPath, snapshot, length);
+    memcpy(tempPath + length, ".tmp", 5);
+}
+
+/**
+ * Commits pending records and closes the log.
+ */
+TransitionLog::~TransitionLog() {
+    close();
+    for (uint16_t i = 0; i < totalBindings; i++) {
+        if (bindings[i]->fsm) {
+            bindings[i]->fsm->setObserver(nullptr);
+        }
+        delete bindings[i];
+    }
+    delete[] bindings;
+    delete[] buffer;
+    delete[] tempPath;
+}
+
+/**
+ * Configures group commit. The record count takes effect on the next `open`.
+ *
+ * @param records Records per commit; 1 syncs every state change.
+ * @param delay Longest time in milliseconds a record may wait, enforced by `poll`.
+ * @return A pointer to this log for method chaining.
+ */
+TransitionLog* TransitionLog::setGroupCommit(const uint16_t records, const unsigned long delay) {
+    nextMaxRecords = records > 0 ? records : 1;
+    maxDelay = delay;
+    return this;
+}
+
+/**
+ * Attaches an FSM. Its state changes are logged from then on.
+ *
+ * @param fsm The FSM to log.
+ * @param instance ID identifying the FSM across restarts.
+ * @return A pointer to this log for method chaining.
+ */
+TransitionLog* TransitionLog::attach(FSM* fsm, const uint16_t instance) {
+    if (totalBindings == bindingCapacity) {
+        const uint16_t capacity = bindingCapacity ? bindingCapacity * 2 : 8;
+        Binding** grown = new Binding*[capacity];
+        for (uint16_t i = 0; i < totalBindings; i++) {
+            grown[i] = bindings[i];
+        }
+        delete[] bindings;
+        bindings = grown;
+        bindingCapacity = capacity;
+    }
+    Binding* binding = new Binding(this, fsm, instance);
+    bindings[totalBindings++] = binding;
+    fsm->setObserver(binding);
+    return this;
+}
+
+/**
+ * Finds the binding of an instance ID.
+ *
+ * @param instance ID of the FSM.
+ * @return The binding, or `nullptr` if no FSM was attached with that ID.
+ */
+TransitionLog::Binding* TransitionLog::find(const uint16_t instance) const {
+    for (uint16_t i = 0; i < totalBindings; i++) {
+        if (bindings[i]->instance == instance) return bindings[i];
+    }
+    return nullptr;
+}
+
+/**
+ * Opens (or creates) the log file.
+ *
+ * @return `true` on success, `false` if the file could not be opened.
+ */
+bool TransitionLog::open() {
+    close();
+    logFd = ::open(logPath, O_RDWR | O_CREAT | O_APPEND, 0644);
+    if (logFd < 0) return false;
+
+    maxRecords = nextMaxRecords;
+    capacity = maxRecords;
+    delete[] buffer;
+    buffer = new uint8_t[static_cast<size_t>(capacity) * RECORD_MAX_SIZE];
+    used = 0;
+    pending = 0;
+    committedSize = lseek(logFd, 0, SEEK_END);
+    tornTail = false;
+    totalRecords = 0;
+    totalCommits = 0;
+    totalErrors = 0;
+    droppedRecords = 0;
+    return true;
+}
+
+/**
+ * Computes the CRC-8 (polynomial 0x07) of a byte range.
+ *
+ * @param data Bytes to check.
+ * @param length Number of bytes.
+ * @return The CRC value.
+ */
+uint8_t TransitionLog::crc8(const uint8_t* data, size_t length) {
+    uint8_t crc = 0;
+    while (length--) {
+        crc ^= *data++;
+        for (uint8_t bit = 0; bit < 8; bit++) {
+            crc = (crc & 0x80) ? static_cast<uint8_t>((crc << 1) ^ 0x07) : static_cast<uint8_t>(crc << 1);
+        }
+    }
+    return crc;
+}
+
+/**
+ * Encodes a record for the current state of an FSM into the commit buffer.
+ *
+ * Behavior:
+ * - Commits the batch once it holds `maxRecords` records.
+ * - Compacts the log once `compactEvery` records were appended since the last compaction.
+ * - Failures are counted in `totalErrors`; the batch stays pending for the next commit.
+ *
+ * @param instance ID of the FSM.
+ * @param fsm The FSM that changed state.
+ */
+void TransitionLog::append(const uint16_t instance, const FSM* fsm) {
+    if (logFd < 0) return;
+    // A full buffer only remains after failed commits: retry, or lose this record
+    if (pending >= capacity && !commit()) {
+        droppedRecords++;
+        return;
+    }
+
+    uint8_t snapshot[FSM::SNAPSHOT_MAX_SIZE];
+    const size_t length = fsm->snapshot(snapshot, sizeof(snapshot));
+
+    uint8_t* record = buffer + used;
+    SnapshotWriter writer(record, RECORD_MAX_SIZE);
+    writer.writeByte(RECORD_MARKER);
+    writer.writeVarint(nextSequence++);
+    writer.writeVarint(instance);
+    writer.writeByte(static_cast<uint8_t>(length));
+    for (size_t i = 0; i < length; i++) {
+        writer.writeByte(snapshot[i]);
+    }
+    const size_t recordLength = writer.getLength();
+    record[recordLength] = crc8(record, recordLength);
+    used += recordLength + 1;
+
+    if (pending++ == 0) {
+        firstPending = millis();
+    }
+    if (pending >= maxRecords) {
+        commit();
+    }
+    if (compactEvery > 0 && ++sinceCompaction >= compactEvery) {
+        compact();
+    }
+}
+
+/**
+ * Writes a whole buffer, retrying short and interrupted writes.
+ *
+ * @param fd Destination descriptor.
+ * @param data Bytes to write.
+ * @param length Number of bytes.
+ * @return `true` if everything was written, `false` on an I/O error.
+ */
+bool TransitionLog::writeAll(const int fd, const uint8_t* data, size_t length) {
+    while (length > 0) {
+        const ssize_t n = write(fd, data, length);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return false;
+        }
+        data += n;
+        length -= n;
+    }
+    return true;
+}
+
+/**
+ * Cuts the log back to its last durable record, if a failed write left bytes after it.
+ *
+ * The log is opened with `O_APPEND`, so records written after a torn tail would
+ * follow it and be lost to the next `recover`, which stops at the torn record.
+ *
+ * @return `true` if the log ends at `committedSize`, `false` if the tail is still there.
+ */
+bool TransitionLog::cutTail() {
+    if (!tornTail) return true;
+    if (ftruncate(logFd, committedSize) != 0 || TRANSITION_LOG_SYNC(logFd) != 0) {
+        totalErrors++;
+        return false;
+    }
+    tornTail = false;
+    return true;
+}
+
+/**
+ * Commits a partial batch once its oldest record waited `maxDelay` milliseconds.
+ */
+void TransitionLog::poll() {
+    if (pending > 0 && millis() - firstPending >= maxDelay) {
+        commit();
+    }
+}
+
+/**
+ * Writes and syncs all pending records.
+ *
+ * Nothing is written while a torn tail from an earlier failure could not be cut.
+ *
+ * @return `true` on success, `false` on an I/O error.
+ */
+bool TransitionLog::commit() {
+    if (pending == 0) return true;
+    if (logFd < 0 || !cutTail()) return false;
+
+    if (!writeAll(logFd, buffer, used) || TRANSITION_LOG_SYNC(logFd) != 0) {
+        totalErrors++;
+        // Drops whatever part of the batch reached the file, so a retry does not
+        // leave a torn record in front of it
+        tornTail = true;
+        cutTail();
+        return false;
+    }
+    committedSize += used;
+    totalRecords += pending;
+    totalCommits++;
+    used = 0;
+    pending = 0;
+    return true;
+}
+
+/**
+ * Writes a snapshot of every attached FSM and empties the log.
+ *
+ * Behavior:
+ * - Commits pending records first, so the snapshot covers every sequence number issued.
+ * - Writes the snapshot to a temporary file, syncs it and renames it over the old one.
+ * - Truncates the log; a crash before that point only leaves records that recovery skips.
+ *
+ * @return `true` on success, `false` on an I/O error.
+ */
+bool TransitionLog::compact() {
+    if (!commit()) return false;
+    sinceCompaction = 0;
+
+    const size_t capacity = 4 + 5 + 3 + static_cast<size_t>(totalBindings) * (3 + 1 + FSM::SNAPSHOT_MAX_SIZE) + 1;
+    uint8_t* data = new uint8_t[capacity];
+    SnapshotWriter writer(data, capacity);
+    for (const uint8_t byte : SNAPSHOT_MAGIC) {
+        writer.writeByte(byte);
+    }
+    writer.writeVarint(nextSequence - 1);
+    writer.writeVarint(totalBindings);
+    for (uint16_t i = 0; i < totalBindings; i++) {
+        uint8_t snapshot[FSM::SNAPSHOT_MAX_SIZE];
+        const size_t length = bindings[i]->fsm->snapshot(snapshot, sizeof(snapshot));
+        writer.writeVarint(bindings[i]->instance);
+        writer.writeByte(static_cast<uint8_t>(length));
+        for (size_t j = 0; j < length; j++) {
+            writer.writeByte(snapshot[j]);
+        }
+    }
+    const size_t length = writer.getLength();
+    data[length] = crc8(data, length);
+
+    const int fd = ::open(tempPath, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    bool ok = fd >= 0 && writeAll(fd, data, length + 1) && fsync(fd) == 0;
+    if (fd >= 0) {
+        ::close(fd);
+    }
+    delete[] data;
+    ok = ok && rename(tempPath, snapshotPath) == 0;
+
+    if (ok) {
+        // Makes the rename itself durable
+        const char* slash = strrchr(snapshotPath, '/');
+        char* directory = nullptr;
+        if (slash) {
+            const size_t dirLength = slash == snapshotPath ? 1 : slash - snapshotPath;
+            directory = new char[dirLength + 1];
+            memcpy(directory, snapshotPath, dirLength);
+            directory[dirLength] = '\0';
+        }
+        const int dirFd = ::open(directory ? directory : ".", O_RDONLY);
+        if (dirFd >= 0) {
+            fsync(dirFd);
+            ::close(dirFd);
+        }
+        delete[] directory;
+    }
+
+    ok = ok && ftruncate(logFd, 0) == 0;
+    if (ok) {
+        // The records are gone even if the sync fails
+        committedSize = 0;
+        tornTail = false;
+        ok = TRANSITION_LOG_SYNC(logFd) == 0;
+    }
+    if (!ok) {
+        totalErrors++;
+    }
+    return ok;
+}
+
+/**
+ * Rebuilds the attached FSMs from the snapshot file and the log.
+ *
+ * Behavior:
+ * - Loads the latest snapshot of each instance from the snapshot file, if valid.
+ * - Replays log records newer than the snapshot, stopping at the first torn record.
+ * - Cuts the log after the last valid record and continues its sequence numbers.
+ * - Restores each FSM once, from the latest snapshot found for it.
+ *
+ * @return The number of FSMs restored.
+ */
+uint16_t TransitionLog::recover() {
+    if (logFd < 0) return 0;
+    for (uint16_t i = 0; i < totalBindings; i++) {
+        bindings[i]->latestLength = 0;
+    }
+
+    uint32_t lastSequence = 0;
+    const int snapshotFd = ::open(snapshotPath, O_RDONLY);
+    if (snapshotFd >= 0) {
+        size_t length = 0;
+        uint8_t* data = readFile(snapshotFd, length);
+        ::close(snapshotFd);
+        if (data && length > sizeof(SNAPSHOT_MAGIC) && memcmp(data, SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC)) == 0 &&
+            crc8(data, length - 1) == data[length - 1]) {
+            SnapshotReader reader(data + sizeof(SNAPSHOT_MAGIC), length - sizeof(SNAPSHOT_MAGIC) - 1);
+            lastSequence = reader.readVarint();
+            const unsigned long entries = reader.readVarint();
+            for (unsigned long i = 0; i < entries && reader.isValid(); i++) {
+                const unsigned long instance = reader.readVarint();
+                const uint8_t size = reader.readByte();
+                Binding* binding = find(static_cast<uint16_t>(instance));
+                for (uint8_t j = 0; j < size; j++) {
+                    const uint8_t byte = reader.readByte();
+                    if (binding && j < sizeof(binding->latest)) binding->latest[j] = byte;
+                }
+                if (binding && reader.isValid() && size <= sizeof(binding->latest)) {
+                    binding->latestLength = size;
+                }
+            }
+        }
+        delete[] data;
+    }
+
+    size_t length = 0;
+    uint8_t* data = readFile(logFd, length);
+    size_t validEnd = 0;
+    uint32_t maxSequence = lastSequence;
+    while (data && validEnd < length && data[validEnd] == RECORD_MARKER) {
+        SnapshotReader reader(data + validEnd, length - validEnd);
+        reader.readByte();
+        const uint32_t sequence = reader.readVarint();
+        const uint16_t instance = reader.readVarint();
+        const uint8_t size = reader.readByte();
+        for (uint8_t j = 0; j < size; j++) {
+            reader.readByte();
+        }
+        const size_t recordLength = reader.getPosition();
+        if (!reader.isValid() || size > FSM::SNAPSHOT_MAX_SIZE || recordLength >= length - validEnd ||
+            crc8(data + validEnd, recordLength) != data[validEnd + recordLength]) {
+            break;
+        }
+        if (sequence > lastSequence) {
+            Binding* binding = find(instance);
+            if (binding) {
+                memcpy(binding->latest, data + validEnd + recordLength - size, size);
+                binding->latestLength = size;
+            }
+        }
+        if (sequence > maxSequence) maxSequence = sequence;
+        validEnd += recordLength + 1;
+    }
+    delete[] data;
+    committedSize = validEnd;
+    if (validEnd < length) {
+        // If the cut fails, commits are refused until a later one succeeds
+        tornTail = true;
+        cutTail();
+    }
+    nextSequence = maxSequence + 1;
+
+    uint16_t restored = 0;
+    for (uint16_t i = 0; i < totalBindings; i++) {
+        Binding* binding = bindings[i];
+        if (binding->latestLength > 0 && binding->fsm->restore(binding->latest, binding->latestLength)) {
+            restored++;
+        }
+    }
+    return restored;
+}
+
+/**
+ * Commits pending records and closes the log file.
+ */
+void TransitionLog::close() {
+    if (logFd < 0) return;
+    commit();
+    ::close(logFd);
+    logFd = -1;
+}
+
+#endif // POSIX
@@ -0,0 +1,535 @@
+#!/usr/bin/env python3
+"""
+Ahead-of-time generator of specialized state machine code.
+
+Responsibilities:
+- Reads a flat SCXML document or a simple table describing states, hooks,
+  timeouts and transitions.
+- Emits a header with a state enum and a switch-based dispatcher, and a stub
+  file with the guards and hooks left to the application.
+
+Design Considerations:
+- The generated class has no virtual calls and no heap: states are enum values,
+  guards and hooks are member functions, and the timeout of the current state is
+  a subtraction against the time it was entered.
+- Transitions of a state are checked in the library's order: priority, condition,
+  event, timeout, then immediate, in document order within each kind. One
+  transition is taken per `run`, as in `FSM` with the default hop limit.
+- A priority transition fires as `PriorityTransition` does: on its event, then on
+  the state's timeout, whichever of the two it declares. Any kind but a condition
+  may add a guard. Combinations the library cannot express, such as a priority
+  transition on a guard alone, are rejected rather than turned into another kind.
+- Hooks receive the events `FSM` passes: the triggering event for event
+  transitions, `Event::none` for the other kinds, and `nullptr` on the initial
+  entry made by `start`.
+- Events are the library's `Event` objects, matched by address: the names of the
+  static events (`buttonPressed`, `frameReceived`, ...) refer to them, and any
+  other name becomes an `Event` member of the generated class.
+- The stub file is only written when missing, so regenerating never overwrites
+  the application's code.
+
+Table format, one declaration per line, `#` starting a comment:
+
+    machine Door
+    initial Closed
+    state Closed timeout=5000 enter exit update
+    Closed -> Open on buttonPressed if isUnlocked   # event, optional guard
+    Closed -> Alarm priority on doorForced after    # priority: event, timeout or both
+    Closed -> Locked if isLockRequested             # condition
+    Open -> Closed after                            # timeout of the state
+    Alarm -> Closed                                 # immediate
+
+SCXML subset: top-level <state> and <final> elements with <transition event=...
+cond=... target=...>. A <send event="E" delay="500ms"/> in <onentry> gives the
+state a timeout, and its transitions on E become timeout transitions.
+Non-empty <onentry>/<onexit> elements get hooks. A `priority="true"` attribute
+(in any namespace) makes a transition a priority transition; its `event` may list
+one event and the timeout event, separated by a space.
+
+Usage:
+    tools/fsmgen.py door.fsm -o examples/
+    tools/fsmgen.py door.scxml --name DoorMachine -o src/
+"""
+
+import argparse
+import os
+import re
+import sys
+import xml.etree.ElementTree as ElementTree
+
+# Kinds, in the order of TransitionPriority.
+PRIORITY, CONDITION, EVENT, TIMEOUT, IMMEDIATE = range(5)
+KIND_NAMES = ("priority", "condition", "event", "timeout", "immediate")
+
+# Static events of the Event class.
+LIBRARY_EVENTS = ("none", "globalTimeout", "localTimeout", "buttonPressed", "buttonReleased",
+                  "serialReceived", "serialSent", "frameReceived")
+
+IDENTIFIER = re.compile(r"^[A-Za-z_][A-Za-z0-9_]*$")
+
+
+class GeneratorError(Exception):
+    """Error in the input, reported with its location."""
+
+
+class Transition:
+    def __init__(self, target, kind, event=None, guard=None, condition=None, after=False):
+        self.target = target
+        self.kind = kind
+        self.event = event
+        self.guard = guard
+        self.condition = condition  # SCXML expression the guard stands for, if any
+        self.after = after  # fired by the state's timeout
+
+
+class State:
+    def __init__(self, name):
+        self.name = name
+        self.timeout = 0
+        self.enter = False
+        self.exit = False
+        self.update = False
+        self.transitions = []
+
+
+class Machine:
+    def __init__(self, name):
+        self.name = name
+        self.initial = None
+        self.states = {}
+        self.order = []
+
+    def add_state(self, name, where):
+        if not IDENTIFIER.match(name):
+            raise GeneratorError(f"{where}: '{name}' is not a valid state name")
+        if name in self.states:
+            raise GeneratorError(f"{where}: state '{name}' declared twice")
+        state = State(name)
+        self.states[name] = state
+        self.order.append(state)
+        return state
+
+    def state(self, name, where):
+        if name not in self.states:
+            raise GeneratorError(f"{where}: unknown state '{name}'")
+        return self.states[name]
+
+
+def parse_duration(text, where):
+    """Converts an SCXML delay ("500ms", "2s", "1.5s" or a bare number of ms) to milliseconds."""
+    match = re.match(r"^\s*([0-9]*\.?[0-9]+)\s*(ms|s)?\s*$", text)
+    if not match:
+        raise GeneratorError(f"{where}: unsupported delay '{text}'")
+    value = float(match.group(1))
+    return int(round(value * 1000 if match.group(2) == "s" else value))
+
+
+def parse_table(path, name):
+    machine = Machine(name)
+    pending = []  # transitions are resolved once every state is known
+    with open(path, encoding="utf-8") as source:
+        for number, line in enumerate(source, 1):
+            where = f"{path}:{number}"
+            words = line.split("#", 1)[0].split()
+            if not words:
+                continue
+            if words[0] == "machine" and len(words) == 2:
+                machine.name = name or words[1]
+            elif words[0] == "initial" and len(words) == 2:
+                machine.initial = words[1]
+            elif words[0] == "state" and len(words) >= 2:
+                state = machine.add_state(words[1], where)
+                for option in words[2:]:
+                    if option.startswith("timeout="):
+                        state.timeout = int(option[len("timeout="):])
+                    elif option in ("enter", "exit", "update"):
+                        setattr(state, option, True)
+                    else:
+                        raise GeneratorError(f"{where}: unknown state option '{option}'")
+            elif len(words) >= 3 and words[1] == "->":
+                pending.append((where, words))
+            else:
+                raise GeneratorError(f"{where}: cannot parse '{line.strip()}'")
+
+    for where, words in pending:
+        source = machine.state(words[0], where)
+        machine.state(words[2], where)
+        event = guard = None
+        priority = after = False
+        rest = words[3:]
+        while rest:
+            word = rest.pop(0)
+            if word == "on" and rest:
+                event = rest.pop(0)
+            elif word == "if" and rest:
+                guard = rest.pop(0)
+            elif word == "priority":
+                priority = True
+            elif word == "after":
+                after = True
+            else:
+                raise GeneratorError(f"{where}: unexpected '{word}'")
+        source.transitions.append(make_transition(source, words[2], event, guard, None, priority, after, where))
+    return machine
+
+
+def local_name(tag):
+    return tag.rsplit("}", 1)[-1]
+
+
+def parse_scxml(path, name):
+    root = ElementTree.parse(path).getroot()
+    if local_name(root.tag) != "scxml":
+        raise GeneratorError(f"{path}: root element is not <scxml>")
+    machine = Machine(name or root.get("name") or os.path.splitext(os.path.basename(path))[0])
+    machine.initial = root.get("initial")
+
+    elements = []
+    for element in root:
+        tag = local_name(element.tag)
+        if tag in ("parallel", "history"):
+            raise GeneratorError(f"{path}: <{tag}> is not supported")
+        if tag not in ("state", "final"):
+            continue
+        if any(local_name(child.tag) in ("state", "parallel", "final") for child in element):
+            raise GeneratorError(f"{path}: nested states in '{element.get('id')}' are not supported")
+        elements.append((machine.add_state(element.get("id", ""), path), element))
+
+    for state, element in elements:
+        timeout_events = set()
+        for child in element:
+            tag = local_name(child.tag)
+            if tag in ("onentry", "onexit") and len(child):
+                sends = [send for send in child if local_name(send.tag) == "send" and send.get("delay")]
+                if tag == "onentry" and sends:
+                    if len(sends) > 1:
+                        raise GeneratorError(f"{path}: state '{state.name}' has more than one delayed <send>")
+                    state.timeout = parse_duration(sends[0].get("delay"), path)
+                    timeout_events.add(sends[0].get("event"))
+                if any(local_name(action.tag) != "send" or not action.get("delay") for action in child):
+                    setattr(state, "enter" if tag == "onentry" else "exit", True)
+
+        for child in element:
+            if local_name(child.tag) != "transition":
+                continue
+            target = child.get("target")
+            if not target or " " in target.strip():
+                raise GeneratorError(f"{path}: transition of '{state.name}' needs exactly one target")
+            machine.state(target, path)
+            events = (child.get("event") or "").split()
+            after = any(event in timeout_events for event in events)
+            others = [event for event in events if event not in timeout_events]
+            if len(others) > 1:
+                raise GeneratorError(f"{path}: transition of '{state.name}' on more than one event")
+            event = others[0] if others else None
+            condition = child.get("cond")
+            guard = None
+            if condition:
+                guard = condition if IDENTIFIER.match(condition) else f"guard{len(state.transitions)}{state.name}"
+            priority = any(local_name(key) == "priority" and value == "true" for key, value in child.attrib.items())
+            state.transitions.append(make_transition(state, target, event, guard,
+                                                     None if guard == condition else condition,
+                                                     priority, after, path))
+    return machine
+
+
+def make_transition(state, target, event, guard, condition, priority, after, where):
+    if event and not IDENTIFIER.match(event):
+        raise GeneratorError(f"{where}: '{event}' is not a valid event name")
+    if after and state.timeout == 0:
+        raise GeneratorError(f"{where}: timeout transition of '{state.name}', which has no timeout")
+    if priority:
+        # PriorityTransition fires on an event, the state's timeout or both, never on a guard alone
+        if not event and not after:
+            raise GeneratorError(f"{where}: priority transition of '{state.name}' needs an event, the timeout "
+                                 f"or both; a guard alone is a condition transition")
+        kind = PRIORITY
+    elif event and after:
+        raise GeneratorError(f"{where}: transition of '{state.name}' on both an event and the timeout "
+                             f"must be a priority transition")
+    elif after:
+        kind = TIMEOUT
+    elif event:
+        kind = EVENT
+    elif guard:
+        kind = CONDITION
+    else:
+        kind = IMMEDIATE
+    return Transition(target, kind, event, guard, condition, after)
+
+
+def constant(name):
+    """Converts a state name to an enum constant: "doorOpen" -> "DOOR_OPEN"."""
+    return re.sub(r"(?<=[a-z0-9])(?=[A-Z])", "_", name).upper()
+
+
+def capitalized(name):
+    return name[0].upper() + name[1:]
+
+
+def event_expression(event):
+    return f"Event::{event}" if event in LIBRARY_EVENTS else f"&{event}"
+
+
+def guards_of(machine):
+    guards = {}
+    for state in machine.order:
+        for transition in state.transitions:
+            if transition.guard and transition.guard not in guards:
+                guards[transition.guard] = transition.condition
+    return guards
+
+
+def custom_events(machine):
+    events = []
+    for state in machine.order:
+        for transition in state.transitions:
+            if transition.event and transition.event not in LIBRARY_EVENTS and transition.event not in events:
+                events.append(transition.event)
+    return events
+
+
+def emit_transition(lines, state, transition):
+    if transition.kind == PRIORITY:
+        # The event first, then the timeout, as PriorityTransition checks them
+        if transition.event:
+            emit_check(lines, state, transition, f"event == {event_expression(transition.event)}", "event")
+        if transition.after:
+            emit_check(lines, state, transition, f"elapsed >= {state.timeout}UL", "Event::none")
+    elif transition.kind == EVENT:
+        emit_check(lines, state, transition, f"event == {event_expression(transition.event)}", "event")
+    elif transition.kind == TIMEOUT:
+        emit_check(lines, state, transition, f"elapsed >= {state.timeout}UL", "Event::none")
+    else:
+        emit_check(lines, state, transition, None, "Event::none")
+
+
+def emit_check(lines, state, transition, trigger_test, trigger):
+    test = [trigger_test] if trigger_test else []
+    if transition.guard:
+        test.append(f"{transition.guard}()")
+    cause = " on the event" if trigger == "event" else " on the timeout" if trigger_test else ""
+    lines.append(f"                // {KIND_NAMES[transition.kind]} transition to {transition.target}"
+                 f"{cause if transition.kind == PRIORITY else ''}")
+    indent = "                "
+    if test:
+        lines.append(f"{indent}if ({' && '.join(test)}) {{")
+        indent += "    "
+    if state.exit:
+        lines.append(f"{indent}onExit{capitalized(state.name)}({trigger});")
+    lines.append(f"{indent}enter(StateId::{constant(transition.target)}, {trigger});")
+    lines.append(f"{indent}return true;")
+    if test:
+        lines.append("                }")
+
+
+def generate_header(machine, stubs_name):
+    name = machine.name
+    guard_macro = constant(name) + "_H"
+    guards = guards_of(machine)
+    events = custom_events(machine)
+    has_timeouts = any(state.timeout for state in machine.order)
+
+    lines = [
+        "/**",
+        f" * {name}: state machine generated by tools/fsmgen.py. Do not edit; regenerate instead.",
+        " *",
+        f" * Guards and hooks are declared here and defined by the application in {stubs_name}.",
+        " */",
+        "",
+        f"#ifndef {guard_macro}",
+        f"#define {guard_macro}",
+        "",
+        "#include <Arduino.h>",
+        '#include "actions/Clock.h"',
+        '#include "events/Event.h"',
+        "",
+        "/**",
+        f" * @brief Switch-based {name} state machine",
+        " *",
+        " * Usage:",
+        " * @code",
+        f" * {name} machine;",
+        " * machine.start();",
+        " *",
+        " * void loop() {",
+        " *     machine.run(source->getEvent());",
+        " * }",
+        " * @endcode",
+        " */",
+        f"class {name} {{",
+        "public:",
+        "    /**",
+        "     * States of the machine.",
+        "     */",
+        "    enum class StateId : uint8_t {",
+    ]
+    lines += [f"        {constant(state.name)}," for state in machine.order]
+    lines += ["    };", ""]
+    for event in events:
+        lines.append(f"    Event {event}{{EventType::EVENT_CUSTOM}}; ///< Custom event `{event}`.")
+    if events:
+        lines.append("")
+    lines += [
+        "    /**",
+        f"     * Enters the initial state, {machine.initial}, and starts running.",
+        "     */",
+        "    void start() {",
+        "        running = true;",
+        f"        enter(StateId::{constant(machine.initial)}, nullptr);",
+        "    }",
+        "",
+        "    /**",
+        "     * Stops the machine, staying in the current state.",
+        "     */",
+        "    void stop() { running = false; }",
+        "",
+        "    /**",
+        "     * Executes one update cycle: takes the first triggered transition of the",
+        "     * current state, or calls its update hook if none is triggered.",
+        "     *",
+        "     * @param event The event presented to event transitions, or `nullptr`.",
+        "     * @return `true` if the machine changed state, `false` otherwise.",
+        "     */",
+        "    bool run(Event* event = nullptr) {",
+        "        if (!running) return false;",
+    ]
+    if has_timeouts:
+        lines.append("        const unsigned long elapsed = Clock::now() - enteredAt;")
+    lines.append("        switch (currentState) {")
+    for state in machine.order:
+        lines.append(f"            case StateId::{constant(state.name)}:")
+        transitions = sorted(state.transitions, key=lambda t: t.kind)
+        for position, transition in enumerate(transitions):
+            emit_transition(lines, state, transition)
+            if not transition.guard and transition.kind == IMMEDIATE:
+                if position + 1 < len(transitions):
+                    print(f"fsmgen: warning: transitions of '{state.name}' after its unguarded immediate "
+                          f"transition can never fire", file=sys.stderr)
+                break
+        else:
+            if state.update:
+                lines.append(f"                onUpdate{capitalized(state.name)}();")
+            lines.append("                break;")
+    lines += [
+        "        }",
+        "        (void) event;",
+    ]
+    if has_timeouts:
+        lines.append("        (void) elapsed;")
+    lines += [
+        "        return false;",
+        "    }",
+        "",
+        "    /**",
+        "     * Retrieves the current state.",
+        "     *",
+        "     * @return The current state.",
+        "     */",
+        "    StateId getCurrentState() const { return currentState; }",
+        "",
+        "    /**",
+        "     * Checks whether the machine is running.",
+        "     *",
+        "     * @return `true` once started and until stopped.",
+        "     */",
+        "    bool isRunning() const { return running; }",
+        "",
+        "private:",
+        f"    StateId currentState{{StateId::{constant(machine.initial)}}}; ///< The current state.",
+        "    unsigned long enteredAt{0}; ///< Time the current state was entered, in ms.",
+        "    bool running{false}; ///< Whether the machine is running.",
+        "",
+        "    void enter(const StateId next, Event* event) {",
+        "        currentState = next;",
+        "        enteredAt = Clock::now();",
+    ]
+    enter_hooks = [state for state in machine.order if state.enter]
+    if enter_hooks:
+        lines.append("        switch (next) {")
+        for state in enter_hooks:
+            lines.append(f"            case StateId::{constant(state.name)}: onEnter{capitalized(state.name)}(event); break;")
+        lines += ["            default: break;", "        }"]
+    else:
+        lines.append("        (void) event;")
+    lines.append("    }")
+
+    declarations = [f"    bool {guard}();" for guard in guards]
+    for state in machine.order:
+        if state.enter:
+            declarations.append(f"    void onEnter{capitalized(state.name)}(Event* event);")
+        if state.exit:
+            declarations.append(f"    void onExit{capitalized(state.name)}(Event* event);")
+        if state.update:
+            declarations.append(f"    void onUpdate{capitalized(state.name)}();")
+    if declarations:
+        lines += ["", f"    // Guards and hooks, defined in {stubs_name}."] + declarations
+    lines += ["};", "", f"#endif //{guard_macro}", ""]
+    return "\n".join(lines)
+
+
+def generate_stubs(machine, header_name):
+    name = machine.name
+    lines = [
+        "/**",
+        f" * Guards and hooks of {name}. Generated once by tools/fsmgen.py; edit freely.",
+        " */",
+        "",
+        f'#include "{header_name}"',
+    ]
+    for guard, condition in guards_of(machine).items():
+        lines += ["", "/**", f" * Guard `{guard}`."]
+        if condition:
+            lines.append(f" * SCXML condition: `{condition}`.")
+        lines += [" */", f"bool {name}::{guard}() {{", "    return false;", "}"]
+    for state in machine.order:
+        title = capitalized(state.name)
+        if state.enter:
+            lines += ["", f"void {name}::onEnter{title}(Event* event) {{", "    (void) event;", "}"]
+        if state.exit:
+            lines += ["", f"void {name}::onExit{title}(Event* event) {{", "    (void) event;", "}"]
+        if state.update:
+            lines += ["", f"void {name}::onUpdate{title}() {{", "}"]
+    lines.append("")
+    return "\n".join(lines)
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Generate a switch-based C++ state machine from SCXML or a table.")
+    parser.add_argument("input", help="SCXML document (.scxml, .xml) or table (any other extension)")
+    parser.add_argument("-o", "--output", default=".", help="output directory")
+    parser.add_argument("--name", help="class name, overriding the one in the input")
+    parser.add_argument("--force-stubs", action="store_true", help="overwrite an existing stub file")
+    arguments = parser.parse_args()
+
+    try:
+        if os.path.splitext(arguments.input)[1].lower() in (".scxml", ".xml"):
+            machine = parse_scxml(arguments.input, arguments.name)
+        else:
+            machine = parse_table(arguments.input, arguments.name)
+        if not machine.name or not IDENTIFIER.match(machine.name):
+            raise GeneratorError(f"{arguments.input}: missing or invalid machine name")
+        if not machine.order:
+            raise GeneratorError(f"{arguments.input}: no states")
+        machine.initial = machine.initial or machine.order[0].name
+        machine.state(machine.initial, arguments.input)
+        if len(machine.order) > 255:
+            raise GeneratorError(f"{arguments.input}: more than 255 states")
+    except (GeneratorError, ElementTree.ParseError, OSError, ValueError) as error:
+        print(f"fsmgen: {error}", file=sys.stderr)
+        return 1
+
+    header_name = f"{machine.name}.h"
+    stubs_name = f"{machine.name}Hooks.cpp"
+    os.makedirs(arguments.output, exist_ok=True)
+    with open(os.path.join(arguments.output, header_name), "w", encoding="utf-8") as header:
+        header.write(generate_header(machine, stubs_name))
+    stubs_path = os.path.join(arguments.output, stubs_name)
+    if arguments.force_stubs or not os.path.exists(stubs_path):
+        with open(stubs_path, "w", encoding="utf-8") as stubs:
+            stubs.write(generate_stubs(machine, header_name))
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())